@@ -0,0 +1,139 @@
+#ifndef TETRAGON_GRAPHICS_ALLOCATORS_HPP
+#define TETRAGON_GRAPHICS_ALLOCATORS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tetragon::graphics {
+
+// Source of CPU staging memory for vertex buffers. All memory is aligned
+// to ALIGNMENT, so staged vectors can be loaded with aligned SIMD loads.
+// Request counters are kept here; system counters are reported by the
+// implementations whenever they have to go to the global heap.
+class StagingAllocator {
+public:
+	static constexpr std::size_t ALIGNMENT = 16;
+
+	struct Statistics {
+		std::uint64_t allocations;
+		std::uint64_t deallocations;
+		std::uint64_t expansions;
+		std::uint64_t systemAllocations;
+		std::size_t allocatedBytes;
+		std::size_t liveBytes;
+		std::size_t peakBytes;
+		std::size_t reservedBytes;
+	};
+
+private:
+	Statistics m_statistics {};
+
+public:
+	StagingAllocator() = default;
+	virtual ~StagingAllocator() = default;
+
+	StagingAllocator(StagingAllocator const&) = delete;
+	StagingAllocator& operator=(StagingAllocator const&) = delete;
+
+	// Shared heap allocator used by buffers that do not choose one.
+	static StagingAllocator& heap();
+
+	[[nodiscard]] void* allocate(std::size_t size);
+	void deallocate(void* pointer, std::size_t size);
+
+	// Grows an allocation, keeping its first usedSize bytes. Expands in
+	// place when the implementation can, and copies otherwise.
+	[[nodiscard]] void* reallocate(void* pointer, std::size_t size, std::size_t usedSize, std::size_t newSize);
+
+	[[nodiscard]] Statistics const& statistics() const;
+	void reset_statistics();
+
+protected:
+	virtual void* do_allocate(std::size_t size) = 0;
+	virtual void do_deallocate(void* pointer, std::size_t size) = 0;
+	virtual bool do_expand(void* pointer, std::size_t size, std::size_t newSize);
+
+	void count_system_allocation(std::size_t size);
+	void count_system_release(std::size_t size);
+
+	static void* system_allocate(std::size_t size);
+	static void system_deallocate(void* pointer);
+};
+
+class HeapAllocator final : public StagingAllocator {
+protected:
+	void* do_allocate(std::size_t size) override;
+	void do_deallocate(void* pointer, std::size_t size) override;
+};
+
+// Bump allocator for transient geometry, e.g. one per frame. Deallocation
+// only reclaims the most recent allocation, which can also grow in place;
+// everything else is reclaimed at once by reset(). Memory handed out
+// before a reset must not be used after it.
+class LinearArena final : public StagingAllocator {
+	static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+	struct Block {
+		std::byte* data;
+		std::size_t size;
+	};
+
+	const std::size_t m_blockSize;
+	std::vector<Block> m_blocks;
+	std::size_t m_block = 0;
+	std::size_t m_offset = 0;
+	std::byte* m_last = nullptr;
+
+public:
+	explicit LinearArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~LinearArena() override;
+
+	void reset();
+	[[nodiscard]] std::size_t used() const;
+
+protected:
+	void* do_allocate(std::size_t size) override;
+	void do_deallocate(void* pointer, std::size_t size) override;
+	bool do_expand(void* pointer, std::size_t size, std::size_t newSize) override;
+};
+
+// Size-class allocator for long-lived buffers. Requests are rounded up to
+// a power of two and served from slabs; freed blocks are kept for reuse by
+// their class until trim(). Requests above the largest class go directly
+// to the heap.
+class PoolAllocator final : public StagingAllocator {
+	static constexpr std::size_t MIN_CLASS_SIZE = 64;
+	static constexpr std::size_t CLASS_COUNT = 15;
+	static constexpr std::size_t SLAB_SIZE = 256 * 1024;
+
+	struct SizeClass {
+		std::vector<std::byte*> free;
+		std::vector<std::byte*> slabs;
+	};
+
+	std::array<SizeClass, CLASS_COUNT> m_classes;
+
+public:
+	static constexpr std::size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE << (CLASS_COUNT - 1);
+
+	PoolAllocator() = default;
+	~PoolAllocator() override;
+
+	// Releases the slabs of all classes without live allocations.
+	void trim();
+
+protected:
+	void* do_allocate(std::size_t size) override;
+	void do_deallocate(void* pointer, std::size_t size) override;
+	bool do_expand(void* pointer, std::size_t size, std::size_t newSize) override;
+
+private:
+	[[nodiscard]] static std::size_t class_index(std::size_t size);
+	[[nodiscard]] static std::size_t slab_size(std::size_t classIndex);
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_ALLOCATORS_HPP
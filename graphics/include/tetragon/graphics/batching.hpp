@@ -0,0 +1,56 @@
+#ifndef TETRAGON_GRAPHICS_BATCHING_HPP
+#define TETRAGON_GRAPHICS_BATCHING_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "layouts.hpp"
+#include "shapes.hpp"
+#include "store.hpp"
+
+namespace tetragon::graphics {
+
+using PositionLayout = VertexLayout<Attribute<"pos", Vector3>>;
+
+// Collects shapes during a frame and draws them with one draw call per
+// shader program. Shapes emit bare Vector3 positions, so every group uses
+// PositionLayout, and all shapes of a frame are written back to back into
+// a single streaming vertex buffer. Single shapes still go through the
+// virtual Shape::buffer_to; submit a ShapeStore to avoid per-shape dispatch.
+class ShapeBatcher final {
+	struct Group {
+		ShaderProgram* program;
+		VertexArray array;
+		std::vector<const Shape*> shapes;
+		std::vector<const ShapeStore*> stores;
+		uint first = 0;
+		uint count = 0;
+	};
+
+	VertexBuffer m_buffer;
+	std::vector<std::unique_ptr<Group>> m_groups;
+	std::size_t m_shapeCount = 0;
+
+public:
+	ShapeBatcher();
+	ShapeBatcher(ShapeBatcher const&) = delete;
+
+	void submit(ShaderProgram& program, Shape const& shape);
+	// The store is uploaded as a whole when drawing, so it has to stay
+	// alive and unchanged until then.
+	void submit(ShaderProgram& program, ShapeStore const& store);
+	void submit(ShaderProgram& program, std::span<const Shape* const> shapes);
+
+	[[nodiscard]] std::size_t shape_count() const;
+	[[nodiscard]] std::size_t group_count() const;
+
+	void draw(GLenum mode = GL_TRIANGLES);
+
+private:
+	Group& group(ShaderProgram& program);
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_BATCHING_HPP
@@ -0,0 +1,57 @@
+#ifndef TETRAGON_GRAPHICS_BINARIES_HPP
+#define TETRAGON_GRAPHICS_BINARIES_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "definitions.hpp"
+
+namespace tetragon::graphics {
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of
+// the program's sources and defines combined with the driver's vendor,
+// renderer and version strings, so a driver update invalidates them.
+class ProgramBinaryCache final {
+	static constexpr std::uint32_t MAGIC = 0x42504754; // "TGPB"
+	static constexpr std::uint32_t VERSION = 1;
+
+	struct Header {
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t key;
+		std::uint32_t format;
+		std::uint32_t length;
+	};
+
+	const std::filesystem::path m_directory;
+	const bool m_supported;
+	std::uint64_t m_driverHash = 0;
+	uint m_hits = 0;
+	uint m_misses = 0;
+
+public:
+	explicit ProgramBinaryCache(std::filesystem::path directory);
+
+	static bool is_supported();
+	static std::filesystem::path default_directory();
+
+	[[nodiscard]] bool enabled() const;
+	[[nodiscard]] std::filesystem::path const& directory() const;
+	[[nodiscard]] uint hits() const;
+	[[nodiscard]] uint misses() const;
+
+	[[nodiscard]] std::uint64_t key(std::uint64_t sourcesHash) const;
+
+	bool load(std::uint64_t key, GLObject program);
+	void store(std::uint64_t key, GLObject program) const;
+	void remove(std::uint64_t key) const;
+
+private:
+	[[nodiscard]] std::filesystem::path path(std::uint64_t key) const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_BINARIES_HPP
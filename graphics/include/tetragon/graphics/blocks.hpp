@@ -0,0 +1,184 @@
+#ifndef TETRAGON_GRAPHICS_BLOCKS_HPP
+#define TETRAGON_GRAPHICS_BLOCKS_HPP
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "matrices.hpp"
+#include "primitives.hpp"
+#include "shaders.hpp"
+
+namespace tetragon::graphics {
+
+namespace std140 {
+
+	// Explicit filler for the gaps std140 leaves between members, e.g.
+	// between a float and a following vec3.
+	template<std::size_t Floats>
+	struct Padding {
+		float value[Floats];
+	};
+
+	template<class T>
+	struct traits;
+
+	template<std::size_t Alignment, std::size_t Size>
+	struct format {
+		static constexpr std::size_t alignment = Alignment;
+		static constexpr std::size_t size = Size;
+	};
+
+	template<> struct traits<float> : format<4, 4> {};
+	template<> struct traits<int> : format<4, 4> {};
+	template<> struct traits<uint> : format<4, 4> {};
+
+	template<> struct traits<Vector2> : format<8, 8> {};
+	template<> struct traits<Vector3> : format<16, 12> {};
+	template<> struct traits<Vector4> : format<16, 16> {};
+
+	template<> struct traits<Matrix4> : format<16, 64> {};
+
+	template<std::size_t Floats>
+	struct traits<Padding<Floats>> : format<4, Floats * 4> {};
+
+	template<class T>
+	concept IsMemberType = requires {
+		traits<T>::alignment;
+		traits<T>::size;
+	};
+
+} // std140
+
+// std140 layout of a uniform block mirrored by a C++ struct whose members
+// are declared in the same order and with the same types as Members. The
+// layout fails to compile unless every member sits at its std140 offset
+// in the natural C++ layout too; insert std140::Padding where it does not.
+template<std140::IsMemberType... Members>
+class Std140Layout {
+	static constexpr std::size_t align_up(const std::size_t size, const std::size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	static constexpr std::size_t count = sizeof...(Members);
+
+	static constexpr std::array<std::size_t, count> compute_offsets(
+			std::array<std::size_t, count> const& alignments, std::array<std::size_t, count> const& sizes) {
+		std::array<std::size_t, count> offsets {};
+		std::size_t end = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			offsets[i] = align_up(end, alignments[i]);
+			end = offsets[i] + sizes[i];
+		}
+		return offsets;
+	}
+
+	static constexpr std::array<std::size_t, count> std140_sizes { std140::traits<Members>::size... };
+	static constexpr std::array<std::size_t, count> native_sizes { sizeof(Members)... };
+
+	static constexpr std::array<std::size_t, count> std140_offsets =
+		compute_offsets({ std140::traits<Members>::alignment... }, std140_sizes);
+	static constexpr std::array<std::size_t, count> native_offsets =
+		compute_offsets({ alignof(Members)... }, native_sizes);
+
+	static constexpr bool is_consistent() {
+		for (std::size_t i = 0; i < count; i++) {
+			if (std140_offsets[i] != native_offsets[i] || std140_sizes[i] != native_sizes[i]) return false;
+		}
+		return true;
+	}
+
+public:
+	static_assert(sizeof...(Members) > 0, "Uniform block must have at least one member");
+	static_assert(is_consistent(), "Uniform block members are not at their std140 offsets, add std140::Padding");
+
+	static constexpr std::array<std::size_t, count> offsets = std140_offsets;
+	static constexpr std::size_t size = align_up(offsets.back() + std140_sizes.back(), 16);
+
+	static constexpr std::size_t native_size =
+		align_up(native_offsets.back() + native_sizes.back(), std::max({ alignof(Members)... }));
+
+	template<class Struct>
+	static constexpr bool matches = sizeof(Struct) == native_size && native_size <= size;
+};
+
+// GL uniform buffer bound to a fixed uniform block binding point. Programs
+// are attached once; afterwards all of them read the same block data.
+class UniformBuffer {
+	const GLObject m_object;
+	const std::string m_name;
+	const uint m_binding;
+	const std::size_t m_size;
+
+public:
+	UniformBuffer(std::string name, uint binding, std::size_t size);
+	UniformBuffer(UniformBuffer const&) = delete;
+	~UniformBuffer();
+
+	[[nodiscard]] std::string const& name() const;
+	[[nodiscard]] uint binding() const;
+	[[nodiscard]] std::size_t size() const;
+
+	bool attach(ShaderProgram& program) const;
+	void bind() const;
+
+protected:
+	void upload(const void* data, std::size_t size) const;
+};
+
+template<class Struct>
+concept IsUniformBlock = requires {
+	typename Struct::Layout;
+	requires Struct::Layout::template matches<Struct>;
+	requires std::is_trivially_copyable_v<Struct>;
+};
+
+// Uniform block whose contents are kept on the CPU and uploaded with a
+// single glBufferSubData the next time the block is flushed or bound.
+template<IsUniformBlock Struct>
+class UniformBlock final : public UniformBuffer {
+	Struct m_value {};
+	bool m_dirty = true;
+
+public:
+	using Layout = typename Struct::Layout;
+
+	UniformBlock(std::string name, const uint binding):
+			UniformBuffer(std::move(name), binding, Layout::size) {}
+
+	[[nodiscard]] Struct const& value() const {
+		return m_value;
+	}
+
+	Struct& edit() {
+		m_dirty = true;
+		return m_value;
+	}
+
+	void set_value(Struct const& value) {
+		m_value = value;
+		m_dirty = true;
+	}
+
+	[[nodiscard]] bool is_dirty() const {
+		return m_dirty;
+	}
+
+	void flush() {
+		if (!m_dirty) return;
+		upload(&m_value, sizeof(Struct));
+		m_dirty = false;
+	}
+
+	void bind() {
+		flush();
+		UniformBuffer::bind();
+	}
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_BLOCKS_HPP
@@ -0,0 +1,202 @@
+#ifndef TETRAGON_GRAPHICS_COMMANDS_HPP
+#define TETRAGON_GRAPHICS_COMMANDS_HPP
+
+#include <glad/glad.h>
+#include <spdlog/spdlog.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "elements.hpp"
+#include "shaders.hpp"
+#include "vertices.hpp"
+
+namespace tetragon::graphics {
+
+enum class CommandType : std::uint8_t {
+	BIND_PROGRAM, SET_UNIFORM, UPLOAD, UPDATE_VERTICES, FLUSH_VERTICES, DRAW_ARRAYS, DRAW_ELEMENTS
+};
+
+// Linear buffer of encoded GL commands. Recording makes no GL calls, so
+// any thread may record into its own buffer; execute() replays the
+// commands on the thread that owns the context. Commands are trivially
+// copyable structs, each preceded by a header and followed by its payload,
+// e.g. a uniform value or the bytes of an upload. Referenced objects have
+// to stay alive until the buffer has been executed.
+class CommandBuffer final {
+	static constexpr std::size_t ALIGNMENT = 8;
+
+	struct Header {
+		CommandType type;
+		std::uint32_t size;
+	};
+
+	using UniformSetter = void (*)(ShaderProgram& program, int location, const std::byte* value);
+
+	struct BindProgram {
+		ShaderProgram* program;
+	};
+
+	struct SetUniform {
+		ShaderProgram* program;
+		UniformSetter setter;
+		int location;
+	};
+
+	struct Upload {
+		GLObject buffer;
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	struct UpdateVertices {
+		VertexBuffer* buffer;
+		std::size_t index;
+		std::size_t size;
+	};
+
+	struct FlushVertices {
+		VertexBuffer* buffer;
+	};
+
+	struct DrawArrays {
+		const VertexArray* array;
+		GLenum mode;
+		uint first;
+		uint count;
+		uint instances;
+	};
+
+	struct DrawElements {
+		const VertexArray* array;
+		ElementBuffer* elements;
+		GLenum mode;
+		int baseVertex;
+		uint instances;
+	};
+
+	std::uint64_t m_order;
+	std::vector<std::byte> m_data;
+	std::size_t m_count = 0;
+
+	template<IsUniformable T>
+	static void set_uniform(ShaderProgram& program, const int location, const std::byte* value) {
+		T uniformValue;
+		memcpy(&uniformValue, value, sizeof(T));
+		Uniform<T>(program, "", location).set_value(uniformValue);
+	}
+
+public:
+	explicit CommandBuffer(std::uint64_t order = 0);
+
+	[[nodiscard]] std::uint64_t order() const;
+	void set_order(std::uint64_t order);
+
+	[[nodiscard]] std::size_t count() const;
+	[[nodiscard]] std::size_t size() const;
+	[[nodiscard]] bool empty() const;
+
+	void bind_program(ShaderProgram& program);
+
+	// Goes through Uniform::set_value on execution, so redundant values are
+	// still skipped by the program's shadow copy. Blank uniforms are dropped.
+	template<IsUniformable T>
+	void set_uniform(Uniform<T> const& uniform, T const& value) {
+		if (uniform.is_blank()) return;
+		static_assert(std::is_trivially_copyable_v<T>, "Uniform values are copied into the command buffer");
+		record(CommandType::SET_UNIFORM, SetUniform { &uniform.program(), &set_uniform<T>, uniform.location() },
+			&value, sizeof(T));
+	}
+
+	// Writes bytes into a GL buffer object, e.g. a page of a GpuBufferPool.
+	void upload(GLObject buffer, std::size_t offset, std::span<const std::byte> data);
+
+	template<class T> requires std::is_trivially_copyable_v<T>
+	void update(VertexBuffer& buffer, const std::size_t index, std::span<const T> vertices) {
+		record(CommandType::UPDATE_VERTICES, UpdateVertices { &buffer, index, vertices.size_bytes() },
+			vertices.data(), vertices.size_bytes());
+	}
+
+	void flush(VertexBuffer& buffer);
+
+	void draw_arrays(VertexArray const& array, uint first, uint count,
+		GLenum mode = GL_TRIANGLES, uint instances = 1);
+	void draw_elements(VertexArray const& array, ElementBuffer& elements,
+		GLenum mode = GL_TRIANGLES, int baseVertex = 0, uint instances = 1);
+
+	void execute() const;
+	void clear();
+
+private:
+	template<class Command>
+	void record(const CommandType type, Command const& command, const void* payload = nullptr,
+			const std::size_t payloadSize = 0) {
+		static_assert(std::is_trivially_copyable_v<Command>, "Commands must be trivially copyable");
+		const std::size_t offset = m_data.size();
+		const std::size_t size = align(sizeof(Header)) + align(sizeof(Command)) + align(payloadSize);
+		if (size > std::numeric_limits<std::uint32_t>::max()) {
+			spdlog::error("Failed to record a command with {} bytes of payload, as commands are limited to 4 GiB",
+				payloadSize);
+			throw std::invalid_argument("Command payload is too large");
+		}
+		m_data.resize(offset + size);
+		std::byte* out = m_data.data() + offset;
+		const Header header { type, static_cast<std::uint32_t>(size) };
+		memcpy(out, &header, sizeof(Header));
+		memcpy(out + align(sizeof(Header)), &command, sizeof(Command));
+		if (payloadSize > 0) {
+			memcpy(out + align(sizeof(Header)) + align(sizeof(Command)), payload, payloadSize);
+		}
+		m_count++;
+	}
+
+	static constexpr std::size_t align(const std::size_t size) {
+		return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+};
+
+// Hands out command buffers to recording threads and executes them on the
+// GL thread in the order of their keys, e.g. the first index of the range
+// a job recorded. Buffers are recycled, so their memory is reused from
+// frame to frame.
+class CommandQueue final {
+public:
+	struct Statistics {
+		std::size_t buffers;
+		std::size_t commands;
+		std::size_t bytes;
+	};
+
+private:
+	std::mutex m_mutex;
+	std::vector<std::unique_ptr<CommandBuffer>> m_recording;
+	std::vector<std::unique_ptr<CommandBuffer>> m_free;
+	Statistics m_statistics {};
+
+public:
+	CommandQueue() = default;
+	CommandQueue(CommandQueue const&) = delete;
+
+	// Thread-safe. The buffer stays valid until the next execute().
+	[[nodiscard]] CommandBuffer& acquire(std::uint64_t order);
+
+	// If a command throws, the buffers after it are not executed, but all
+	// buffers are still cleared and recycled before the exception propagates.
+	void execute();
+
+	[[nodiscard]] Statistics const& statistics() const;
+
+private:
+	void recycle(std::vector<std::unique_ptr<CommandBuffer>>& buffers);
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_COMMANDS_HPP
@@ -0,0 +1,99 @@
+#ifndef TETRAGON_GRAPHICS_ELEMENTS_HPP
+#define TETRAGON_GRAPHICS_ELEMENTS_HPP
+
+#include <glad/glad.h>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "vertices.hpp"
+
+namespace tetragon::graphics {
+
+class ElementBuffer final {
+public:
+	using Index = std::uint32_t;
+
+	enum class IndexType : GLenum {
+		UNSIGNED_SHORT = GL_UNSIGNED_SHORT,
+		UNSIGNED_INT = GL_UNSIGNED_INT
+	};
+private:
+	const GLObject m_object;
+	const VertexBuffer::Usage m_usage;
+
+	std::vector<Index> m_indices;
+	std::vector<std::uint16_t> m_shortIndices;
+	Index m_maxIndex = 0;
+	IndexType m_type = IndexType::UNSIGNED_SHORT;
+
+	std::size_t m_gpuSize = 0;
+	bool m_dirty = false;
+	std::string m_name = "Elements";
+
+public:
+	ElementBuffer();
+	explicit ElementBuffer(VertexBuffer::Usage usage);
+	ElementBuffer(ElementBuffer const&) = delete;
+	~ElementBuffer();
+
+	[[nodiscard]] std::size_t count() const;
+	[[nodiscard]] IndexType index_type() const;
+	[[nodiscard]] std::size_t index_size() const;
+
+	void bind();
+	void flush();
+
+	void reserve(std::size_t indexCount);
+	void clear();
+
+	void buffer(std::span<const Index> indices, Index baseVertex = 0);
+};
+
+template<class T>
+struct WeldedVertices {
+	std::vector<T> vertices;
+	std::vector<ElementBuffer::Index> indices;
+};
+
+// Merges bit-wise identical vertices, so that each unique vertex is stored
+// once and referenced from the returned index list.
+template<class T> requires std::is_trivially_copyable_v<T>
+WeldedVertices<T> weld_vertices(std::span<const T> vertices) {
+	constexpr ElementBuffer::Index EMPTY = ~ElementBuffer::Index(0);
+
+	const auto hash = [](T const& vertex) {
+		std::uint64_t value = 14695981039346656037ull;
+		const auto* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+		for (std::size_t i = 0; i < sizeof(T); i++) {
+			value = (value ^ bytes[i]) * 1099511628211ull;
+		}
+		return value;
+	};
+
+	WeldedVertices<T> result;
+	result.indices.reserve(vertices.size());
+	std::vector<ElementBuffer::Index> table(std::bit_ceil(vertices.size() * 2 + 1), EMPTY);
+	const std::size_t mask = table.size() - 1;
+
+	for (T const& vertex : vertices) {
+		std::size_t slot = hash(vertex) & mask;
+		while (table[slot] != EMPTY
+				&& memcmp(&result.vertices[table[slot]], &vertex, sizeof(T)) != 0) {
+			slot = (slot + 1) & mask;
+		}
+		if (table[slot] == EMPTY) {
+			table[slot] = static_cast<ElementBuffer::Index>(result.vertices.size());
+			result.vertices.push_back(vertex);
+		}
+		result.indices.push_back(table[slot]);
+	}
+	return result;
+}
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_ELEMENTS_HPP
@@ -0,0 +1,83 @@
+#ifndef TETRAGON_GRAPHICS_FORMATS_HPP
+#define TETRAGON_GRAPHICS_FORMATS_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "layouts.hpp"
+#include "primitives.hpp"
+
+namespace tetragon::graphics {
+
+// Compressed vertex components. Each type is a plain storage struct that
+// can be used as a vertex member and described with Attribute<>; values
+// are produced with the pack_* functions or the batch compress() kernels.
+
+template<std::size_t N>
+struct HalfVector {
+	std::uint16_t values[N];
+};
+
+template<std::size_t N>
+struct Snorm16Vector {
+	std::int16_t values[N];
+};
+
+template<std::size_t N>
+struct Unorm8Vector {
+	std::uint8_t values[N];
+};
+
+// Signed normalized x, y and z in 10 bits each plus a 2-bit w, matching
+// GL_INT_2_10_10_10_REV. Suited for normals and tangents.
+struct PackedNormal {
+	std::uint32_t bits;
+};
+
+using Half2 = HalfVector<2>;
+using Half3 = HalfVector<3>;
+using Half4 = HalfVector<4>;
+using Snorm16x2 = Snorm16Vector<2>;
+using Snorm16x3 = Snorm16Vector<3>;
+using Snorm16x4 = Snorm16Vector<4>;
+using Unorm8x4 = Unorm8Vector<4>;
+
+template<std::size_t N> struct attribute_traits<HalfVector<N>> : attribute_format<GL_HALF_FLOAT, N> {};
+template<std::size_t N> struct attribute_traits<Snorm16Vector<N>> : attribute_format<GL_SHORT, N, true> {};
+template<std::size_t N> struct attribute_traits<Unorm8Vector<N>> : attribute_format<GL_UNSIGNED_BYTE, N, true> {};
+template<> struct attribute_traits<PackedNormal> : attribute_format<GL_INT_2_10_10_10_REV, 4, true> {};
+
+[[nodiscard]] std::uint16_t float_to_half(float value);
+[[nodiscard]] float half_to_float(std::uint16_t half);
+
+[[nodiscard]] Half3 pack_half(Vector3 vector);
+[[nodiscard]] Half4 pack_half(Vector4 vector);
+[[nodiscard]] Snorm16x3 pack_snorm16(Vector3 vector);
+[[nodiscard]] Snorm16x4 pack_snorm16(Vector4 vector);
+[[nodiscard]] Unorm8x4 pack_unorm8(Vector4 vector);
+[[nodiscard]] PackedNormal pack_normal(Vector3 normal, float w = 0);
+
+[[nodiscard]] Vector3 unpack(Half3 vector);
+[[nodiscard]] Vector4 unpack(Half4 vector);
+[[nodiscard]] Vector3 unpack(Snorm16x3 vector);
+[[nodiscard]] Vector4 unpack(Snorm16x4 vector);
+[[nodiscard]] Vector4 unpack(Unorm8x4 vector);
+[[nodiscard]] Vector4 unpack(PackedNormal normal);
+
+namespace kernels {
+
+	// Batch conversions; outputs must be as long as the inputs.
+	void compress(std::span<const Vector3> vectors, std::span<Half3> result);
+	void compress(std::span<const Vector4> vectors, std::span<Half4> result);
+	void compress(std::span<const Vector3> vectors, std::span<Snorm16x3> result);
+	void compress(std::span<const Vector4> vectors, std::span<Snorm16x4> result);
+	void compress(std::span<const Vector4> vectors, std::span<Unorm8x4> result);
+	void compress(std::span<const Vector3> normals, std::span<PackedNormal> result);
+
+} // kernels
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_FORMATS_HPP
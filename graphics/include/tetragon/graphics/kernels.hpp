@@ -0,0 +1,56 @@
+#ifndef TETRAGON_GRAPHICS_KERNELS_HPP
+#define TETRAGON_GRAPHICS_KERNELS_HPP
+
+#include <cstddef>
+#include <span>
+
+#include "matrices.hpp"
+#include "primitives.hpp"
+#include "vertices.hpp"
+
+namespace tetragon::graphics::kernels {
+
+// Batch operations over contiguous vector arrays. Outputs must be as long
+// as the inputs and may alias them. The instruction set is chosen when the
+// library is built, see backend().
+
+[[nodiscard]] const char* backend();
+
+void add(std::span<const Vector4> first, std::span<const Vector4> second, std::span<Vector4> result);
+void scale(std::span<const Vector4> vectors, float factor, std::span<Vector4> result);
+void dot(std::span<const Vector4> first, std::span<const Vector4> second, std::span<float> result);
+void normalize(std::span<const Vector4> vectors, std::span<Vector4> result);
+
+void transform(Matrix4 const& matrix, std::span<const Vector4> vectors, std::span<Vector4> result);
+void transform_points(Matrix4 const& matrix, std::span<const Vector3> points, std::span<Vector3> result);
+
+// Positions split into separate x, y and z arrays of equal length, which
+// lets the transform process a full register of points per instruction.
+struct PositionStreams {
+	std::span<const float> x, y, z;
+
+	[[nodiscard]] std::size_t size() const { return x.size(); }
+};
+
+struct OutputStreams {
+	std::span<float> x, y, z;
+
+	[[nodiscard]] std::size_t size() const { return x.size(); }
+};
+
+void transform_streams(Matrix4 const& matrix, PositionStreams positions, OutputStreams result);
+
+// Writes transformed positions as three floats at `offset` within each
+// `stride`-byte element of destination, e.g. the position of an
+// interleaved vertex.
+void transform_streams(Matrix4 const& matrix, PositionStreams positions,
+	std::span<std::byte> destination, std::size_t stride, std::size_t offset = 0);
+
+// Appends the transformed positions to buffer as new vertices. Attributes
+// other than the position at `offset` are left for the caller to fill.
+std::span<std::byte> transform_into(Matrix4 const& matrix, PositionStreams positions,
+	VertexBuffer& buffer, std::size_t offset = 0);
+
+} // tetragon::graphics::kernels
+
+#endif // TETRAGON_GRAPHICS_KERNELS_HPP
@@ -0,0 +1,108 @@
+#ifndef TETRAGON_GRAPHICS_LAYOUTS_HPP
+#define TETRAGON_GRAPHICS_LAYOUTS_HPP
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "primitives.hpp"
+#include "vertices.hpp"
+
+namespace tetragon::graphics {
+
+template<std::size_t N>
+struct FixedString {
+	char value[N] {};
+
+	constexpr FixedString(const char (&string)[N]) {
+		std::copy_n(string, N, value);
+	}
+};
+
+template<class T>
+struct attribute_traits;
+
+template<GLenum Type, uint Size, bool Normalized = false>
+struct attribute_format {
+	static constexpr GLenum type = Type;
+	static constexpr uint size = Size;
+	static constexpr bool normalized = Normalized;
+};
+
+template<> struct attribute_traits<float> : attribute_format<GL_FLOAT, 1> {};
+template<> struct attribute_traits<int> : attribute_format<GL_INT, 1> {};
+template<> struct attribute_traits<uint> : attribute_format<GL_UNSIGNED_INT, 1> {};
+
+template<> struct attribute_traits<Vector2> : attribute_format<GL_FLOAT, 2> {};
+template<> struct attribute_traits<Vector3> : attribute_format<GL_FLOAT, 3> {};
+template<> struct attribute_traits<Vector4> : attribute_format<GL_FLOAT, 4> {};
+
+template<class T>
+concept IsAttributeType = requires {
+	attribute_traits<T>::type;
+	attribute_traits<T>::size;
+	attribute_traits<T>::normalized;
+};
+
+template<FixedString Name, IsAttributeType T>
+struct Attribute {
+	using type = T;
+	using traits = attribute_traits<T>;
+	static constexpr const char* name = Name.value;
+};
+
+// Interleaved layout of a vertex struct whose members are declared in the
+// same order and with the same types as Attributes. Offsets follow the
+// natural C++ member layout, so `matches<Vertex>` holds for such a struct.
+template<class... Attributes>
+class VertexLayout {
+	static constexpr std::size_t align_up(const std::size_t size, const std::size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	static constexpr std::array<std::size_t, sizeof...(Attributes)> sizes { sizeof(typename Attributes::type)... };
+
+	static constexpr std::array<std::size_t, sizeof...(Attributes)> compute_offsets() {
+		constexpr std::array<std::size_t, sizeof...(Attributes)> alignments { alignof(typename Attributes::type)... };
+		std::array<std::size_t, sizeof...(Attributes)> offsets {};
+		std::size_t end = 0;
+		for (std::size_t i = 0; i < sizeof...(Attributes); i++) {
+			offsets[i] = align_up(end, alignments[i]);
+			end = offsets[i] + sizes[i];
+		}
+		return offsets;
+	}
+
+	template<std::size_t... I>
+	static std::array<VertexAttribute, sizeof...(Attributes)> make_attributes(std::index_sequence<I...>) {
+		return { VertexAttribute(
+			Attributes::name,
+			Attributes::traits::size,
+			Attributes::traits::type,
+			Attributes::traits::normalized,
+			stride,
+			offsets[I]
+		)... };
+	}
+
+public:
+	static_assert(sizeof...(Attributes) > 0, "Vertex layout must have at least one attribute");
+
+	static constexpr std::size_t count = sizeof...(Attributes);
+	static constexpr std::size_t alignment = std::max({ alignof(typename Attributes::type)... });
+	static constexpr std::array<std::size_t, count> offsets = compute_offsets();
+	static constexpr std::size_t stride = align_up(offsets.back() + sizes.back(), alignment);
+
+	template<class Vertex>
+	static constexpr bool matches = sizeof(Vertex) == stride && alignof(Vertex) == alignment;
+
+	static std::array<VertexAttribute, count> attributes() {
+		return make_attributes(std::index_sequence_for<Attributes...>());
+	}
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_LAYOUTS_HPP
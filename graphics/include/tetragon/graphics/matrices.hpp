@@ -0,0 +1,69 @@
+#ifndef TETRAGON_GRAPHICS_MATRICES_HPP
+#define TETRAGON_GRAPHICS_MATRICES_HPP
+
+#include "definitions.hpp"
+#include "primitives.hpp"
+
+namespace tetragon::graphics {
+
+// Square matrices stored column-major, the order GL expects them in, so
+// they can be uploaded without transposing. Matrix4 columns are aligned
+// for SIMD loads.
+struct Matrix3 {
+	static constexpr uint SIZE = 3;
+
+	float values[SIZE * SIZE] {};
+
+	Matrix3() = default;
+	explicit Matrix3(float diagonal);
+
+	static Matrix3 identity();
+
+	[[nodiscard]] float& operator()(uint row, uint column);
+	[[nodiscard]] float operator()(uint row, uint column) const;
+
+	[[nodiscard]] const float* data() const;
+	[[nodiscard]] Matrix3 transposed() const;
+
+	bool operator==(Matrix3 const& other) const;
+};
+
+struct alignas(16) Matrix4 {
+	static constexpr uint SIZE = 4;
+
+	float values[SIZE * SIZE] {};
+
+	Matrix4() = default;
+	explicit Matrix4(float diagonal);
+
+	static Matrix4 identity();
+	static Matrix4 translation(Vector3 offset);
+	static Matrix4 scaling(Vector3 factors);
+
+	// Right-handed view and projection matrices mapping depth to [-1, 1],
+	// as GL does by default. Angles are in radians.
+	static Matrix4 look_at(Vector3 eye, Vector3 target, Vector3 up);
+	static Matrix4 perspective(float fieldOfView, float aspectRatio, float near, float far);
+	static Matrix4 orthographic(float left, float right, float bottom, float top, float near, float far);
+
+	[[nodiscard]] float& operator()(uint row, uint column);
+	[[nodiscard]] float operator()(uint row, uint column) const;
+
+	[[nodiscard]] const float* data() const;
+	[[nodiscard]] Vector4 column(uint index) const;
+	[[nodiscard]] Matrix4 transposed() const;
+	[[nodiscard]] float determinant() const;
+	[[nodiscard]] Matrix4 inverse() const;
+
+	[[nodiscard]] Vector3 transform_point(Vector3 point) const;
+	[[nodiscard]] Vector3 transform_direction(Vector3 direction) const;
+
+	Matrix4 operator*(Matrix4 const& other) const;
+	Vector4 operator*(Vector4 const& vector) const;
+
+	bool operator==(Matrix4 const& other) const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_MATRICES_HPP
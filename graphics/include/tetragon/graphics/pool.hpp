@@ -0,0 +1,147 @@
+#ifndef TETRAGON_GRAPHICS_POOL_HPP
+#define TETRAGON_GRAPHICS_POOL_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "definitions.hpp"
+#include "vertices.hpp"
+
+namespace tetragon::graphics {
+
+// Suballocates vertex data from a few large GL buffers (pages), so many
+// meshes share one bound buffer and are drawn with base-vertex offsets.
+// Every page keeps an offset-sorted free list; freed blocks are coalesced
+// with their neighbours. Defragmentation moves allocations but keeps the
+// buffer object of every page, so vertex arrays stay valid and only the
+// offsets behind the handles change.
+class GpuBufferPool final {
+public:
+	static constexpr std::size_t MIN_PAGE_SIZE = 4 * 1024 * 1024;
+	static constexpr std::size_t MAX_PAGE_SIZE = 64 * 1024 * 1024;
+	static constexpr std::size_t DEFAULT_PAGE_SIZE = 16 * 1024 * 1024;
+
+	struct Handle {
+		uint index = static_cast<uint>(-1);
+		uint generation = 0;
+	};
+
+	struct Range {
+		uint page;
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	struct Statistics {
+		std::size_t pages;
+		std::size_t capacity;
+		std::size_t used;
+		std::size_t free;
+		std::size_t largestFree;
+		std::size_t allocations;
+		std::size_t freeBlocks;
+		std::uint64_t defragmentations;
+		std::uint64_t movedBytes;
+	};
+
+private:
+	struct Block {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	struct Page {
+		GLObject object;
+		std::size_t capacity;
+		std::size_t used;
+		uint allocations;
+		std::vector<Block> free;
+	};
+
+	struct Slot {
+		Range range;
+		std::size_t alignment;
+		uint generation;
+		bool live;
+	};
+
+	const std::size_t m_pageSize;
+	const VertexBuffer::Usage m_usage;
+	std::vector<Page> m_pages;
+	std::vector<Slot> m_slots;
+	std::vector<uint> m_freeSlots;
+
+	GLObject m_scratch = 0;
+	std::size_t m_scratchSize = 0;
+
+	std::uint64_t m_defragmentations = 0;
+	std::uint64_t m_movedBytes = 0;
+
+public:
+	explicit GpuBufferPool(std::size_t pageSize = DEFAULT_PAGE_SIZE,
+			VertexBuffer::Usage usage = VertexBuffer::Usage::STATIC);
+	~GpuBufferPool();
+
+	GpuBufferPool(GpuBufferPool const&) = delete;
+	GpuBufferPool& operator=(GpuBufferPool const&) = delete;
+
+	[[nodiscard]] std::size_t page_size() const;
+	[[nodiscard]] std::size_t page_count() const;
+	[[nodiscard]] GLObject page_object(uint page) const;
+
+	// Offsets are multiples of alignment, which need not be a power of two,
+	// so allocating with the vertex size as alignment makes the offset a
+	// whole number of vertices.
+	[[nodiscard]] Handle allocate(std::size_t size, std::size_t alignment = 4);
+	void free(Handle handle);
+
+	template<class Vertex>
+	[[nodiscard]] Handle allocate_vertices(const std::size_t vertexCount) {
+		return allocate(vertexCount * sizeof(Vertex), sizeof(Vertex));
+	}
+
+	[[nodiscard]] bool valid(Handle handle) const;
+	[[nodiscard]] Range range(Handle handle) const;
+	[[nodiscard]] int base_vertex(Handle handle, std::size_t vertexSize) const;
+
+	void upload(Handle handle, const void* data, std::size_t size, std::size_t offset = 0);
+
+	template<class T> requires std::is_trivially_copyable_v<T>
+	void upload(const Handle handle, std::span<const T> values, const std::size_t first = 0) {
+		upload(handle, values.data(), values.size_bytes(), first * sizeof(T));
+	}
+
+	// Binds a page as the source of attributes of the bound vertex array,
+	// with locations taken from the bound shader program.
+	void attach(uint page, VertexAttribute const& attribute) const;
+
+	template<class Layout>
+	void attach(const uint page) const {
+		for (VertexAttribute const& attribute : Layout::attributes()) {
+			attach(page, attribute);
+		}
+	}
+
+	// Compacts the allocations of every fragmented page towards its start.
+	// Returns the number of allocations that moved.
+	std::size_t defragment();
+	void release_empty_pages();
+
+	[[nodiscard]] Statistics statistics() const;
+
+private:
+	uint create_page(std::size_t capacity);
+	bool allocate_from(Page& page, std::size_t size, std::size_t alignment, std::size_t& offset);
+	void release(Page& page, std::size_t offset, std::size_t size);
+	std::size_t compact(uint page);
+	void reserve_scratch(std::size_t size);
+	[[nodiscard]] Slot const& slot(Handle handle) const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_POOL_HPP
@@ -1,126 +1,299 @@
 #ifndef TETRAGON_GRAPHICS_PRIMITIVES_HPP
 #define TETRAGON_GRAPHICS_PRIMITIVES_HPP
 
-#ifdef CXX_CONSTEXPR
-#define CONSTEXPR constexpr
-#else
-#define CONSTEXPR
-#endif
-#include "vertices.hpp"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
 
-namespace tetragon::graphics {
+#include "simd.hpp"
 
-struct Vector2;
-struct Vector3;
-struct Vector4;
+namespace tetragon::graphics {
 
 using Scalar = float;
 
-struct Vector2 : Vertex {
-	float x = 0, y = 0;
-
-	CONSTEXPR Vector2() = default;
-	CONSTEXPR Vector2(float x, float y);
-
-	[[nodiscard]] const void* vertex_data() const;
-	[[nodiscard]] std::size_t vertex_size() const;
+namespace detail {
+	// Newton-Raphson square root for constant evaluation. Every iterate after
+	// the first is above the root, so the sequence stops once it stops falling.
+	constexpr double sqrt_newton_raphson(const double x) {
+		if (!(x >= 0 && x < std::numeric_limits<double>::infinity())) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+		if (x == 0) return 0;
+		double current = x;
+		for (int i = 0; i < 128; i++) {
+			const double next = 0.5 * (current + x / current);
+			if (i > 0 && next >= current) break;
+			current = next;
+		}
+		return current;
+	}
+
+	template<class T>
+	constexpr T sqrt(const T x) {
+		if (std::is_constant_evaluated()) {
+			return static_cast<T>(sqrt_newton_raphson(static_cast<double>(x)));
+		}
+		return std::sqrt(x);
+	}
+}
+
+// Fixed-size vector. The common sizes have named components; all of them
+// are aggregates, so `Vector3 { 1, 2, 3 }` works in constant expressions.
+template<std::size_t N, class T = Scalar>
+struct Vector {
+	static constexpr std::size_t size = N;
+
+	T values[N] {};
+
+	[[nodiscard]] constexpr T& operator[](const std::size_t i) { return values[i]; }
+	[[nodiscard]] constexpr T operator[](const std::size_t i) const { return values[i]; }
+
+	[[nodiscard]] const void* vertex_data() const { return values; }
+	[[nodiscard]] std::size_t vertex_size() const { return N * sizeof(T); }
+
+	constexpr bool operator==(Vector const&) const = default;
+};
 
-	[[nodiscard]] CONSTEXPR float length() const;
-	[[nodiscard]] CONSTEXPR float length_squared() const;
+template<class T>
+struct Vector<2, T> {
+	static constexpr std::size_t size = 2;
 
-	CONSTEXPR Vector2 operator+(Scalar const& other) const;
-	CONSTEXPR Vector2 operator+(Vector2 const& other) const;
-	CONSTEXPR Vector3 operator+(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator+(Vector4 const& other) const;
+	T x = 0, y = 0;
 
-	CONSTEXPR Vector2 operator-(Scalar const& other) const;
-	CONSTEXPR Vector2 operator-(Vector2 const& other) const;
-	CONSTEXPR Vector3 operator-(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator-(Vector4 const& other) const;
+	[[nodiscard]] constexpr T& operator[](const std::size_t i) { return i == 0 ? x : y; }
+	[[nodiscard]] constexpr T operator[](const std::size_t i) const { return i == 0 ? x : y; }
 
-	CONSTEXPR Vector2 operator*(Scalar multiplier) const;
-	CONSTEXPR Vector2 operator*(Vector2 multiplier) const;
+	[[nodiscard]] const void* vertex_data() const { return &x; }
+	[[nodiscard]] std::size_t vertex_size() const { return size * sizeof(T); }
 
-	CONSTEXPR Vector2 operator/(Scalar divider) const;
-	CONSTEXPR Vector2 operator/(Vector2 divider) const;
+	[[nodiscard]] constexpr T length_squared() const { return x * x + y * y; }
+	[[nodiscard]] constexpr T length() const { return detail::sqrt(length_squared()); }
 
-	CONSTEXPR Vector2 operator-() const;
+	template<std::size_t M>
+	constexpr operator Vector<M, T>() const;
 
-	CONSTEXPR operator Vector3() const;
-	CONSTEXPR operator Vector4() const;
+	constexpr bool operator==(Vector const&) const = default;
 };
 
-struct Vector3 : Vector2 {
-	float z = 0;
+template<class T>
+struct Vector<3, T> {
+	static constexpr std::size_t size = 3;
 
-	CONSTEXPR Vector3() = default;
-	CONSTEXPR Vector3(float x, float y, float z);
+	T x = 0, y = 0, z = 0;
 
-	[[nodiscard]] const void* vertex_data() const;
-	[[nodiscard]] std::size_t vertex_size() const;
+	[[nodiscard]] constexpr T& operator[](const std::size_t i) { return i == 0 ? x : i == 1 ? y : z; }
+	[[nodiscard]] constexpr T operator[](const std::size_t i) const { return i == 0 ? x : i == 1 ? y : z; }
 
-	[[nodiscard]] CONSTEXPR float length() const;
-	[[nodiscard]] CONSTEXPR float length_squared() const;
+	[[nodiscard]] const void* vertex_data() const { return &x; }
+	[[nodiscard]] std::size_t vertex_size() const { return size * sizeof(T); }
 
-	CONSTEXPR Vector3 operator+(Scalar const& other) const;
-	CONSTEXPR Vector3 operator+(Vector2 const& other) const;
-	CONSTEXPR Vector3 operator+(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator+(Vector4 const& other) const;
+	[[nodiscard]] constexpr T length_squared() const { return x * x + y * y + z * z; }
+	[[nodiscard]] constexpr T length() const { return detail::sqrt(length_squared()); }
 
-	CONSTEXPR Vector3 operator-(Scalar const& other) const;
-	CONSTEXPR Vector3 operator-(Vector2 const& other) const;
-	CONSTEXPR Vector3 operator-(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator-(Vector4 const& other) const;
+	template<std::size_t M>
+	constexpr operator Vector<M, T>() const;
 
-	CONSTEXPR Vector3 operator*(Scalar multiplier) const;
-	CONSTEXPR Vector3 operator*(Vector3 multiplier) const;
+	constexpr bool operator==(Vector const&) const = default;
+};
 
-	CONSTEXPR Vector3 operator/(Scalar divider) const;
-	CONSTEXPR Vector3 operator/(Vector3 divider) const;
+// Four-component vectors are aligned to fill one SSE register.
+template<class T>
+struct alignas(16) Vector<4, T> {
+	static constexpr std::size_t size = 4;
 
-	CONSTEXPR Vector3 operator-() const;
+	T x = 0, y = 0, z = 0, w = 0;
 
-	CONSTEXPR operator Vector2() const;
-	CONSTEXPR operator Vector4() const;
-};
+	[[nodiscard]] constexpr T& operator[](const std::size_t i) { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
+	[[nodiscard]] constexpr T operator[](const std::size_t i) const { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
 
-struct Vector4 : Vector3 {
-	float w = 0;
+	[[nodiscard]] const void* vertex_data() const { return &x; }
+	[[nodiscard]] std::size_t vertex_size() const { return size * sizeof(T); }
 
-	CONSTEXPR Vector4() = default;
-	CONSTEXPR Vector4(float x, float y, float z, float w);
+	[[nodiscard]] constexpr T length_squared() const { return x * x + y * y + z * z + w * w; }
+	[[nodiscard]] constexpr T length() const { return detail::sqrt(length_squared()); }
 
-	[[nodiscard]] const void* vertex_data() const;
-	[[nodiscard]] std::size_t vertex_size() const;
+	template<std::size_t M>
+	constexpr operator Vector<M, T>() const;
 
-	[[nodiscard]] CONSTEXPR float length() const;
-	[[nodiscard]] CONSTEXPR float length_squared() const;
+	constexpr bool operator==(Vector const&) const = default;
+};
 
-	CONSTEXPR Vector4 operator+(Scalar const& other) const;
-	CONSTEXPR Vector4 operator+(Vector2 const& other) const;
-	CONSTEXPR Vector4 operator+(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator+(Vector4 const& other) const;
+using Vector2 = Vector<2>;
+using Vector3 = Vector<3>;
+using Vector4 = Vector<4>;
+
+namespace detail {
+	template<std::size_t M, std::size_t N, class T>
+	constexpr Vector<M, T> resize(Vector<N, T> const& vector) {
+		Vector<M, T> result {};
+		for (std::size_t i = 0; i < M && i < N; i++) {
+			result[i] = vector[i];
+		}
+		return result;
+	}
+
+	template<std::size_t N, class T, class Operation>
+	constexpr Vector<N, T> combine(Vector<N, T> const& first, Vector<N, T> const& second, Operation operation) {
+		Vector<N, T> result {};
+		for (std::size_t i = 0; i < N; i++) {
+			result[i] = operation(first[i], second[i]);
+		}
+		return result;
+	}
+
+#ifdef TETRAGON_SIMD_SSE
+	inline __m128 load(Vector4 const& vector) {
+		return _mm_load_ps(&vector.x);
+	}
+
+	inline Vector4 store(const __m128 value) {
+		Vector4 vector;
+		_mm_store_ps(&vector.x, value);
+		return vector;
+	}
+#endif
+}
+
+// Conversions between sizes drop trailing components or fill them with zero
+template<class T>
+template<std::size_t M>
+constexpr Vector<2, T>::operator Vector<M, T>() const { return detail::resize<M>(*this); }
+
+template<class T>
+template<std::size_t M>
+constexpr Vector<3, T>::operator Vector<M, T>() const { return detail::resize<M>(*this); }
+
+template<class T>
+template<std::size_t M>
+constexpr Vector<4, T>::operator Vector<M, T>() const { return detail::resize<M>(*this); }
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator+(Vector<N, T> const& first, Vector<N, T> const& second) {
+	return detail::combine(first, second, [](T a, T b) { return a + b; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator-(Vector<N, T> const& first, Vector<N, T> const& second) {
+	return detail::combine(first, second, [](T a, T b) { return a - b; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator*(Vector<N, T> const& first, Vector<N, T> const& second) {
+	return detail::combine(first, second, [](T a, T b) { return a * b; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator/(Vector<N, T> const& first, Vector<N, T> const& second) {
+	return detail::combine(first, second, [](T a, T b) { return a / b; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator+(Vector<N, T> const& vector, const std::type_identity_t<T> scalar) {
+	return detail::combine(vector, vector, [scalar](T a, T) { return a + scalar; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator-(Vector<N, T> const& vector, const std::type_identity_t<T> scalar) {
+	return detail::combine(vector, vector, [scalar](T a, T) { return a - scalar; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator*(Vector<N, T> const& vector, const std::type_identity_t<T> scalar) {
+	return detail::combine(vector, vector, [scalar](T a, T) { return a * scalar; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator*(const std::type_identity_t<T> scalar, Vector<N, T> const& vector) {
+	return vector * scalar;
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator/(Vector<N, T> const& vector, const std::type_identity_t<T> scalar) {
+	return detail::combine(vector, vector, [scalar](T a, T) { return a / scalar; });
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> operator-(Vector<N, T> const& vector) {
+	return detail::combine(vector, vector, [](T a, T) { return -a; });
+}
+
+constexpr Vector4 operator+(Vector4 const& first, Vector4 const& second) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_add_ps(detail::load(first), detail::load(second)));
+#endif
+	return { first.x + second.x, first.y + second.y, first.z + second.z, first.w + second.w };
+}
 
-	CONSTEXPR Vector4 operator-(Scalar const& other) const;
-	CONSTEXPR Vector4 operator-(Vector2 const& other) const;
-	CONSTEXPR Vector4 operator-(Vector3 const& other) const;
-	CONSTEXPR Vector4 operator-(Vector4 const& other) const;
+constexpr Vector4 operator-(Vector4 const& first, Vector4 const& second) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_sub_ps(detail::load(first), detail::load(second)));
+#endif
+	return { first.x - second.x, first.y - second.y, first.z - second.z, first.w - second.w };
+}
 
-	CONSTEXPR Vector4 operator*(Scalar multiplier) const;
-	CONSTEXPR Vector4 operator*(Vector4 multiplier) const;
+constexpr Vector4 operator*(Vector4 const& first, Vector4 const& second) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_mul_ps(detail::load(first), detail::load(second)));
+#endif
+	return { first.x * second.x, first.y * second.y, first.z * second.z, first.w * second.w };
+}
 
-	CONSTEXPR Vector4 operator/(Scalar divider) const;
-	CONSTEXPR Vector4 operator/(Vector4 divider) const;
+constexpr Vector4 operator/(Vector4 const& first, Vector4 const& second) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_div_ps(detail::load(first), detail::load(second)));
+#endif
+	return { first.x / second.x, first.y / second.y, first.z / second.z, first.w / second.w };
+}
 
-	CONSTEXPR Vector4 operator-() const;
+constexpr Vector4 operator*(Vector4 const& vector, const Scalar scalar) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_mul_ps(detail::load(vector), _mm_set1_ps(scalar)));
+#endif
+	return { vector.x * scalar, vector.y * scalar, vector.z * scalar, vector.w * scalar };
+}
 
-	CONSTEXPR operator Vector2() const;
-	CONSTEXPR operator Vector3() const;
-};
+constexpr Vector4 operator/(Vector4 const& vector, const Scalar scalar) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_div_ps(detail::load(vector), _mm_set1_ps(scalar)));
+#endif
+	return { vector.x / scalar, vector.y / scalar, vector.z / scalar, vector.w / scalar };
+}
 
-CONSTEXPR Vector2 vec(float x, float y);
-CONSTEXPR Vector3 vec(float x, float y, float z);
-CONSTEXPR Vector4 vec(float x, float y, float z, float w);
+constexpr Vector4 operator-(Vector4 const& vector) {
+#ifdef TETRAGON_SIMD_SSE
+	if (!std::is_constant_evaluated()) return detail::store(_mm_xor_ps(detail::load(vector), _mm_set1_ps(-0.f)));
+#endif
+	return { -vector.x, -vector.y, -vector.z, -vector.w };
+}
+
+template<std::size_t N, class T>
+constexpr T dot(Vector<N, T> const& first, Vector<N, T> const& second) {
+	T result = 0;
+	for (std::size_t i = 0; i < N; i++) {
+		result += first[i] * second[i];
+	}
+	return result;
+}
+
+template<std::size_t N, class T>
+constexpr Vector<N, T> normalized(Vector<N, T> const& vector) {
+	const T length = detail::sqrt(dot(vector, vector));
+	return length != 0 ? vector / length : Vector<N, T> {};
+}
+
+template<class T>
+constexpr Vector<3, T> cross(Vector<3, T> const& first, Vector<3, T> const& second) {
+	return {
+		first.y * second.z - first.z * second.y,
+		first.z * second.x - first.x * second.z,
+		first.x * second.y - first.y * second.x
+	};
+}
+
+constexpr Vector2 vec(const float x, const float y) { return { x, y }; }
+constexpr Vector3 vec(const float x, const float y, const float z) { return { x, y, z }; }
+constexpr Vector4 vec(const float x, const float y, const float z, const float w) { return { x, y, z, w }; }
 
 } // tetragon::graphics
 
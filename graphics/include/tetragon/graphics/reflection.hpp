@@ -0,0 +1,67 @@
+#ifndef TETRAGON_GRAPHICS_REFLECTION_HPP
+#define TETRAGON_GRAPHICS_REFLECTION_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tetragon::graphics {
+
+constexpr std::uint64_t hash_name(const std::string_view name) {
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const char c : name) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+	}
+	return hash;
+}
+
+constexpr std::uint64_t combine_hash(const std::uint64_t seed, const std::uint64_t value) {
+	return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// Name of a uniform or attribute together with its hash. String literals
+// are hashed at compile time; other names have to be wrapped explicitly.
+struct HashedName {
+	std::string_view name;
+	std::uint64_t hash;
+
+	template<std::size_t N>
+	consteval HashedName(const char (&literal)[N]):
+			name(literal, N - 1), hash(hash_name(name)) {}
+
+	constexpr explicit HashedName(const char* name):
+			name(name), hash(hash_name(this->name)) {}
+};
+
+struct ProgramResource {
+	std::string name;
+	std::uint64_t hash;
+	int location;
+	GLenum type;
+	int size;
+	// Location of every array element, resolved at link time; empty for
+	// attributes
+	std::vector<int> elements;
+};
+
+class ResourceTable {
+	std::vector<ProgramResource> m_resources;
+	std::vector<int> m_slots;
+	std::size_t m_mask = 0;
+
+public:
+	ResourceTable() = default;
+	explicit ResourceTable(std::vector<ProgramResource> resources);
+
+	[[nodiscard]] const ProgramResource* find(HashedName name) const;
+
+	[[nodiscard]] std::size_t size() const;
+	[[nodiscard]] std::vector<ProgramResource> const& resources() const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_REFLECTION_HPP
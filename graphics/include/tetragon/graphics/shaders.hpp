@@ -3,17 +3,33 @@
 
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
-
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "primitives.hpp"
+#include "reflection.hpp"
 #include "vertices.hpp"
 
 namespace tetragon::graphics {
 
-struct Vector3;
+struct Matrix3;
+struct Matrix4;
+class ProgramBinaryCache;
 
 enum class ShaderType {
 	VERTEX, FRAGMENT	
 };
 
+struct ShaderSource {
+	ShaderType type;
+	std::string source;
+};
+
 class Shader final {
 	const ShaderType m_type;
 	const GLObject m_object;
@@ -28,6 +44,7 @@ public:
 };
 
 class ShaderProgram;
+class PendingProgram;
 
 template<class>
 struct is_uniformable : std::bool_constant<false> {};
@@ -37,11 +54,68 @@ template<> struct is_uniformable<float> : std::bool_constant<true> {};
 template<> struct is_uniformable<int> : std::bool_constant<true> {};
 template<> struct is_uniformable<uint> : std::bool_constant<true> {};
 
+template<> struct is_uniformable<Vector2> : std::bool_constant<true> {};
 template<> struct is_uniformable<Vector3> : std::bool_constant<true> {};
+template<> struct is_uniformable<Vector4> : std::bool_constant<true> {};
+
+template<> struct is_uniformable<Matrix3> : std::bool_constant<true> {};
+template<> struct is_uniformable<Matrix4> : std::bool_constant<true> {};
 
 template<class T>
 concept IsUniformable = is_uniformable<T>::value;
 
+constexpr bool is_sampler_type(const GLenum type) {
+	switch (type) {
+		case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+		case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+		case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_BUFFER:
+		case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+		case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+			return true;
+		default:
+			return false;
+	}
+}
+
+template<class>
+struct uniform_type;
+
+template<> struct uniform_type<double> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_DOUBLE; }
+};
+template<> struct uniform_type<float> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT; }
+};
+template<> struct uniform_type<int> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_INT || type == GL_BOOL || is_sampler_type(type); }
+};
+template<> struct uniform_type<uint> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_UNSIGNED_INT || type == GL_BOOL; }
+};
+
+template<> struct uniform_type<Vector2> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT_VEC2; }
+};
+template<> struct uniform_type<Vector3> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT_VEC3; }
+};
+template<> struct uniform_type<Vector4> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT_VEC4; }
+};
+
+template<> struct uniform_type<Matrix3> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT_MAT3; }
+};
+template<> struct uniform_type<Matrix4> {
+	static constexpr bool accepts(const GLenum type) { return type == GL_FLOAT_MAT4; }
+};
+
 template<IsUniformable T>
 class Uniform {
 	ShaderProgram& m_program;
@@ -91,14 +165,71 @@ public:
 	Uniform<T> operator=(Uniform<T> const& other) {
 		*this = other;
 	}
+
+private:
+	void upload(T const& value) const;
+};
+
+// Uniform array uploaded with a single glUniform*v call. Values beyond the
+// array size declared in the shader are ignored.
+template<IsUniformable T>
+class UniformArray {
+	ShaderProgram& m_program;
+	const char* m_name;
+	int m_location;
+	std::span<const int> m_elements;
+	std::size_t m_size;
+
+public:
+	UniformArray(ShaderProgram& program, const char* name, const std::span<const int> elements):
+			m_program(program), m_name(name), m_location(elements.empty() ? -1 : elements.front()),
+			m_elements(elements), m_size(elements.size()) {}
+
+	static UniformArray<T> blank(ShaderProgram& program, const char* name) {
+		return UniformArray<T>(program, name, {});
+	}
+
+	void set_values(std::span<const T> values, std::size_t first = 0);
+
+	[[nodiscard]] std::vector<T> values() const;
+
+	[[nodiscard]] ShaderProgram& program() const {
+		return m_program;
+	}
+
+	[[nodiscard]] const char* name() const {
+		return m_name;
+	}
+
+	[[nodiscard]] int location() const {
+		return m_location;
+	}
+
+	[[nodiscard]] std::size_t size() const {
+		return m_size;
+	}
+
+	[[nodiscard]] bool is_blank() const {
+		return m_location < 0;
+	}
+
+private:
+	void upload(std::span<const T> values, std::size_t first) const;
 };
 
 class ShaderProgram {
 	static ShaderProgram* boundInstance;
 
 	const GLObject m_object;
+	ResourceTable m_uniforms;
+	ResourceTable m_attributes;
+	std::vector<std::vector<std::byte>> m_uniformValues;
 
 	explicit ShaderProgram(GLObject program);
+
+	bool store_uniform(int location, const void* value, std::size_t size);
+	[[nodiscard]] const std::byte* stored_uniform(int location, std::size_t size) const;
+	[[nodiscard]] std::byte* stored_uniform(int location, std::size_t size);
 public:
 	ShaderProgram(ShaderProgram const&) = delete;
 	~ShaderProgram();
@@ -109,32 +240,152 @@ public:
 	[[nodiscard]] bool is_bound() const;
 	[[nodiscard]] uint get_attribute_location(VertexAttribute const& attribute) const;
 
-	bool has_uniform(const char* name) const;
+	bool has_uniform(HashedName name) const;
+
+	[[nodiscard]] ResourceTable const& uniforms() const;
+	[[nodiscard]] ResourceTable const& attributes() const;
 
 	template<IsUniformable T>
-	Uniform<T> uniform(const char* name) {
-		int location = glGetUniformLocation(m_object, name);
-		if (location < 0) {
-			spdlog::warn("Could not find uniform with name `{}`", name);
+	Uniform<T> uniform(const HashedName name) {
+		const ProgramResource* uniform = m_uniforms.find(name);
+		if (uniform == nullptr) {
+			spdlog::warn("Could not find uniform with name `{}`", name.name);
 			spdlog::warn("Returning a blank Uniform");
-			return Uniform<T>::blank(*this, name);
+			return Uniform<T>::blank(*this, name.name.data());
 		}
-		return Uniform<T>(*this, name, location);
+		if (!uniform_type<T>::accepts(uniform->type)) {
+			spdlog::error("Uniform `{}` has GLSL type {:#x}, which does not match the requested type",
+				name.name, uniform->type);
+			spdlog::warn("Returning a blank Uniform");
+			return Uniform<T>::blank(*this, uniform->name.c_str());
+		}
+		return Uniform<T>(*this, uniform->name.c_str(), uniform->location);
+	}
+
+	template<IsUniformable T>
+	UniformArray<T> uniform_array(const HashedName name) {
+		const ProgramResource* uniform = m_uniforms.find(name);
+		if (uniform == nullptr) {
+			spdlog::warn("Could not find uniform array with name `{}`", name.name);
+			spdlog::warn("Returning a blank UniformArray");
+			return UniformArray<T>::blank(*this, name.name.data());
+		}
+		if (!uniform_type<T>::accepts(uniform->type)) {
+			spdlog::error("Uniform array `{}` has GLSL type {:#x}, which does not match the requested type",
+				name.name, uniform->type);
+			spdlog::warn("Returning a blank UniformArray");
+			return UniformArray<T>::blank(*this, uniform->name.c_str());
+		}
+		return UniformArray<T>(*this, uniform->name.c_str(), uniform->elements);
 	}
 
 	class Builder {
 		GLObject m_object;
+		std::vector<ShaderSource> m_sources;
+		std::vector<std::pair<std::string, std::string>> m_defines;
+		bool m_precompiled = false;
 	public:
 		Builder();
 
 		Builder& attach_shader(Shader const& shader);
+		Builder& attach_source(ShaderType type, std::string source);
+		Builder& add_define(std::string name, std::string value = "");
+
+		[[nodiscard]] std::uint64_t sources_hash() const;
+
 		[[nodiscard]] ShaderProgram build() const;
+		[[nodiscard]] ShaderProgram build(ProgramBinaryCache& cache) const;
+
+		[[nodiscard]] PendingProgram build_async() const;
+		[[nodiscard]] PendingProgram build_async(ProgramBinaryCache& cache) const;
+	private:
+		[[nodiscard]] std::vector<GLObject> compile_and_link() const;
 	};
 
 	template<IsUniformable T>
 	friend class Uniform;
+	template<IsUniformable T>
+	friend class UniformArray;
+	friend class PendingProgram;
+	friend class UniformBuffer;
+};
+
+// Program whose shaders were submitted to the driver without waiting for
+// them to compile. Status queries are deferred until get(), so several
+// programs can compile in parallel. With KHR_parallel_shader_compile,
+// is_ready() polls without blocking; otherwise it always reports ready
+// and get() blocks on the driver.
+class PendingProgram final {
+	GLObject m_object;
+	std::vector<GLObject> m_shaders;
+	ProgramBinaryCache* m_cache;
+	std::uint64_t m_key;
+	bool m_taken = false;
+
+	PendingProgram(GLObject program, std::vector<GLObject> shaders,
+		ProgramBinaryCache* cache = nullptr, std::uint64_t key = 0);
+public:
+	PendingProgram(PendingProgram const&) = delete;
+	PendingProgram(PendingProgram&& other) noexcept;
+	~PendingProgram();
+
+	static bool is_parallel_supported();
+	static void set_max_compiler_threads(uint count);
+
+	[[nodiscard]] bool is_ready() const;
+	[[nodiscard]] bool is_taken() const;
+
+	void wait() const;
+	[[nodiscard]] ShaderProgram get();
+
+	friend class ShaderProgram::Builder;
 };
 
+template<IsUniformable T>
+void Uniform<T>::set_value(T const& value) {
+	if (m_blank || !m_program.store_uniform(m_location, &value, sizeof(T))) return;
+	bind_program();
+	upload(value);
+}
+
+template<IsUniformable T>
+T Uniform<T>::value() const {
+	T value {};
+	if (m_blank) return value;
+	if (const std::byte* stored = m_program.stored_uniform(m_location, sizeof(T))) {
+		memcpy(&value, stored, sizeof(T));
+	}
+	return value;
+}
+
+template<IsUniformable T>
+void UniformArray<T>::set_values(std::span<const T> values, const std::size_t first) {
+	if (is_blank() || first >= m_size) return;
+	values = values.first(std::min(values.size(), m_size - first));
+	if (values.empty()) return;
+
+	// The shadow copy covers the whole array, seeded at link, so partial
+	// updates merge into it. Without one, the values are uploaded as is.
+	if (std::byte* stored = m_program.stored_uniform(m_location, m_size * sizeof(T))) {
+		std::byte* target = stored + first * sizeof(T);
+		if (memcmp(target, values.data(), values.size_bytes()) == 0) return;
+		memcpy(target, values.data(), values.size_bytes());
+	}
+
+	m_program.bind();
+	upload(values, first);
+}
+
+template<IsUniformable T>
+std::vector<T> UniformArray<T>::values() const {
+	std::vector<T> values(m_size);
+	if (is_blank()) return values;
+	if (const std::byte* stored = m_program.stored_uniform(m_location, m_size * sizeof(T))) {
+		memcpy(values.data(), stored, m_size * sizeof(T));
+	}
+	return values;
+}
+
 } // tetragon::graphics
 
 #endif // TETRAGON_GRAPHICS_SHADERS_HPP
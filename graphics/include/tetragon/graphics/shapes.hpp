@@ -1,6 +1,7 @@
 #ifndef SHAPES_HPP
 #define SHAPES_HPP
 
+#include "elements.hpp"
 #include "primitives.hpp"
 #include "shaders.hpp"
 
@@ -11,6 +12,7 @@ namespace tetragon::graphics {
         virtual ~Shape() = default;
 
         virtual void buffer_to(VertexBuffer& buffer) const = 0;
+        virtual void buffer_to(VertexBuffer& buffer, ElementBuffer& elements) const;
     };
 
     class Triangle final : public Shape {
@@ -20,17 +22,20 @@ namespace tetragon::graphics {
         Triangle() = default;
         Triangle(Vector3, Vector3, Vector3 );
 
+        using Shape::buffer_to;
         void buffer_to(VertexBuffer& buffer) const override;
     };
 
-    // class Square final : public Shape {
-    //     Triangle a, b;
-    // public:
-    //     Square(Vertex, Vertex);
-    //
-    //     [[nodiscard]] const Vertex* vertecies() const override;
-    //     [[nodiscard]] unsigned int vertex_count() const override;
-    // };
+    class Square final : public Shape {
+    public:
+        Vector3 min, max;
+
+        Square() = default;
+        Square(Vector3 firstCorner, Vector3 secondCorner);
+
+        void buffer_to(VertexBuffer& buffer) const override;
+        void buffer_to(VertexBuffer& buffer, ElementBuffer& elements) const override;
+    };
 
 } // tetragon::graphics
 
@@ -0,0 +1,23 @@
+#ifndef TETRAGON_GRAPHICS_SIMD_HPP
+#define TETRAGON_GRAPHICS_SIMD_HPP
+
+// Instruction sets available to the vector math, picked from the target
+// the translation unit is compiled for. Define TETRAGON_SIMD_SCALAR to
+// force the portable fallback.
+#if !defined(TETRAGON_SIMD_SCALAR)
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define TETRAGON_SIMD_SSE 1
+#		include <immintrin.h>
+#	endif
+#	if defined(TETRAGON_SIMD_SSE) && defined(__AVX2__)
+#		define TETRAGON_SIMD_AVX2 1
+#	endif
+#	if defined(TETRAGON_SIMD_SSE) && defined(__FMA__)
+#		define TETRAGON_SIMD_FMA 1
+#	endif
+#	if defined(TETRAGON_SIMD_SSE) && defined(__F16C__) && defined(__AVX__)
+#		define TETRAGON_SIMD_F16C 1
+#	endif
+#endif
+
+#endif // TETRAGON_GRAPHICS_SIMD_HPP
@@ -0,0 +1,71 @@
+#ifndef TETRAGON_GRAPHICS_STATE_HPP
+#define TETRAGON_GRAPHICS_STATE_HPP
+
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+
+namespace tetragon::graphics {
+
+// Shadow copy of the GL bindings of one context. Binds that would not
+// change anything are skipped and counted as avoided. Element array buffer
+// bindings are part of vertex array state, so they are tracked per array.
+// Indexed binds also replace the generic binding of their target.
+class GLStateCache final {
+	struct BufferBinding {
+		GLenum target;
+		GLObject buffer;
+	};
+
+	GLObject m_program = 0;
+	GLObject m_vertexArray = 0;
+	std::array<BufferBinding, 6> m_buffers {{
+		{ GL_ARRAY_BUFFER, 0 },
+		{ GL_COPY_READ_BUFFER, 0 },
+		{ GL_COPY_WRITE_BUFFER, 0 },
+		{ GL_UNIFORM_BUFFER, 0 },
+		{ GL_PIXEL_PACK_BUFFER, 0 },
+		{ GL_PIXEL_UNPACK_BUFFER, 0 }
+	}};
+	std::unordered_map<GLObject, GLObject> m_elementBuffers;
+	std::vector<GLObject> m_uniformBuffers;
+	std::array<int, 4> m_viewport {};
+	bool m_viewportKnown = false;
+
+	std::uint64_t m_issued = 0;
+	std::uint64_t m_avoided = 0;
+
+public:
+	static GLStateCache& current();
+
+	void use_program(GLObject program);
+	void bind_vertex_array(GLObject vertexArray);
+	void bind_buffer(GLenum target, GLObject buffer);
+	void bind_buffer_base(GLenum target, uint index, GLObject buffer);
+	void set_viewport(int x, int y, int width, int height);
+
+	[[nodiscard]] GLObject program() const;
+	[[nodiscard]] GLObject vertex_array() const;
+	[[nodiscard]] GLObject buffer(GLenum target) const;
+
+	void forget_program(GLObject program);
+	void forget_vertex_array(GLObject vertexArray);
+	void forget_buffer(GLObject buffer);
+	void invalidate();
+
+	[[nodiscard]] std::uint64_t issued_calls() const;
+	[[nodiscard]] std::uint64_t avoided_calls() const;
+	void reset_statistics();
+
+private:
+	BufferBinding* find_binding(GLenum target);
+	[[nodiscard]] bool skip(bool redundant);
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_STATE_HPP
@@ -0,0 +1,53 @@
+#ifndef TETRAGON_GRAPHICS_STORE_HPP
+#define TETRAGON_GRAPHICS_STORE_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "elements.hpp"
+#include "primitives.hpp"
+#include "shapes.hpp"
+
+namespace tetragon::graphics {
+
+// Shapes kept by type in contiguous storage, uploaded as Vector3 positions
+// without virtual dispatch. Triangles are stored as their vertices, so they
+// upload with one copy; squares are stored as structure of arrays and
+// expanded into vertices in a single pass over the staged memory.
+class ShapeStore final {
+	struct Squares {
+		std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+	};
+
+	std::vector<Vector3> m_triangles;
+	Squares m_squares;
+
+public:
+	std::size_t add(Triangle const& triangle);
+	std::size_t add(Square const& square);
+	void add(std::span<const Triangle> triangles);
+	void add(std::span<const Square> squares);
+
+	void set(std::size_t index, Triangle const& triangle);
+	void set(std::size_t index, Square const& square);
+
+	[[nodiscard]] std::size_t triangle_count() const;
+	[[nodiscard]] std::size_t square_count() const;
+	[[nodiscard]] std::size_t vertex_count() const;
+	[[nodiscard]] std::size_t indexed_vertex_count() const;
+	[[nodiscard]] std::size_t index_count() const;
+	[[nodiscard]] bool empty() const;
+
+	void reserve(std::size_t triangleCount, std::size_t squareCount);
+	void clear();
+
+	// Appends all shapes as triangle lists, six vertices per square.
+	void upload(VertexBuffer& buffer) const;
+	// Appends four vertices per square and indexes them from elements.
+	void upload(VertexBuffer& buffer, ElementBuffer& elements) const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_STORE_HPP
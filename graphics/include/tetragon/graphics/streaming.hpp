@@ -0,0 +1,66 @@
+#ifndef TETRAGON_GRAPHICS_STREAMING_HPP
+#define TETRAGON_GRAPHICS_STREAMING_HPP
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+
+#include "definitions.hpp"
+
+namespace tetragon::graphics {
+
+// GL buffer storage for per-frame geometry. The buffer is split into
+// FRAME_REGIONS regions, one per frame in flight. With ARB_buffer_storage
+// the whole buffer stays persistently mapped and a region is only reused
+// once the fence placed after its frame is signaled. Without it, data is
+// appended with unsynchronized maps and the buffer is orphaned when full.
+class StreamingStorage final {
+public:
+	static constexpr uint FRAME_REGIONS = 3;
+	static constexpr std::size_t MIN_REGION_SIZE = 1 << 16;
+
+private:
+	using byte = char;
+
+	GLObject m_object = 0;
+	const std::size_t m_alignment;
+	std::size_t m_regionSize;
+	const bool m_persistent;
+
+	byte* m_mapped = nullptr;
+	std::array<GLsync, FRAME_REGIONS> m_fences {};
+	uint m_region = 0;
+
+	std::size_t m_cursor = 0;
+	std::size_t m_frameOffset = 0;
+	uint m_stalls = 0;
+
+public:
+	StreamingStorage(std::size_t regionSize, std::size_t alignment);
+	StreamingStorage(StreamingStorage const&) = delete;
+	~StreamingStorage();
+
+	static bool is_persistent_supported();
+
+	[[nodiscard]] GLObject object() const;
+	[[nodiscard]] bool is_persistent() const;
+	[[nodiscard]] std::size_t region_size() const;
+	[[nodiscard]] std::size_t frame_offset() const;
+	[[nodiscard]] uint stalls() const;
+
+	void begin_frame();
+	void end_frame();
+
+	[[nodiscard]] byte* frame_pointer() const;
+	void upload(const void* ptr, std::size_t size);
+	void grow(std::size_t regionSize, std::size_t preservedSize);
+
+private:
+	void allocate();
+	void release();
+	void wait_region(uint region);
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_STREAMING_HPP
@@ -0,0 +1,138 @@
+#ifndef TETRAGON_GRAPHICS_TESSELLATION_HPP
+#define TETRAGON_GRAPHICS_TESSELLATION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <tetragon/jobs.hpp>
+
+#include "elements.hpp"
+#include "primitives.hpp"
+
+namespace tetragon::graphics {
+
+struct Rectangle {
+	Vector2 min, max;
+	float z = 0;
+};
+
+struct Ellipse {
+	Vector2 center, radii;
+	float z = 0;
+};
+
+// Filled polygons and stroked polylines of one frame. Points of all paths
+// share one array; paths only keep their range into it.
+class TessellationBatch final {
+public:
+	struct Path {
+		std::size_t first;
+		std::size_t count;
+		float z;
+		float width;
+		bool closed;
+	};
+
+private:
+	std::vector<Rectangle> m_rectangles;
+	std::vector<Ellipse> m_ellipses;
+	std::vector<Path> m_polygons;
+	std::vector<Path> m_polylines;
+	std::vector<Vector2> m_points;
+
+public:
+	void add(Rectangle const& rectangle);
+	void add(Ellipse const& ellipse);
+	void add_circle(Vector2 center, float radius, float z = 0);
+	// Simple polygon in either winding; concave polygons are ear clipped.
+	void add_polygon(std::span<const Vector2> points, float z = 0);
+	void add_polyline(std::span<const Vector2> points, float width, bool closed = false, float z = 0);
+
+	[[nodiscard]] std::span<const Rectangle> rectangles() const;
+	[[nodiscard]] std::span<const Ellipse> ellipses() const;
+	[[nodiscard]] std::span<const Path> polygons() const;
+	[[nodiscard]] std::span<const Path> polylines() const;
+	[[nodiscard]] std::span<const Vector2> points() const;
+
+	[[nodiscard]] std::size_t size() const;
+	[[nodiscard]] bool empty() const;
+	void clear();
+};
+
+// Turns a batch into indexed triangles, written straight into the staging
+// memory of a Vector3 vertex buffer. Vertex and index counts of every shape
+// are known up front, so large batches are split into chunks that the job
+// scheduler tessellates in parallel into disjoint ranges.
+class Tessellator final {
+public:
+	static constexpr float DEFAULT_TOLERANCE = 0.001f;
+	static constexpr uint MIN_SEGMENTS = 8;
+	static constexpr uint MAX_SEGMENTS = 1024;
+	static constexpr float MITER_LIMIT = 4;
+
+	struct Range {
+		uint firstVertex;
+		uint vertexCount;
+		std::size_t firstIndex;
+		std::size_t indexCount;
+	};
+
+	struct Statistics {
+		std::size_t shapes;
+		std::size_t vertices;
+		std::size_t indices;
+		std::size_t chunks;
+		std::chrono::microseconds duration;
+	};
+
+private:
+	static constexpr std::size_t MIN_CHUNK_SHAPES = 512;
+
+	enum class Kind : std::uint8_t {
+		RECTANGLE, ELLIPSE, POLYGON, POLYLINE
+	};
+
+	struct Item {
+		Kind kind;
+		uint index;
+		uint segments;
+		uint firstVertex;
+		std::size_t firstIndex;
+	};
+
+	float m_tolerance;
+	jobs::Scheduler& m_scheduler;
+	std::vector<Item> m_items;
+	std::vector<ElementBuffer::Index> m_indices;
+	Statistics m_statistics {};
+
+public:
+	// Tolerance is the largest distance between a curve and its segments,
+	// in the units of the shapes.
+	explicit Tessellator(float tolerance = DEFAULT_TOLERANCE,
+		jobs::Scheduler& scheduler = jobs::Scheduler::global());
+
+	[[nodiscard]] float tolerance() const;
+	void set_tolerance(float tolerance);
+
+	[[nodiscard]] static uint segment_count(Ellipse const& ellipse, float tolerance);
+
+	Range tessellate(TessellationBatch const& batch, VertexBuffer& buffer, ElementBuffer& elements);
+	// Tessellates into memory without touching GL. Indices are relative to
+	// the first vertex and stay valid until the next call.
+	std::span<const ElementBuffer::Index> tessellate(TessellationBatch const& batch, std::vector<Vector3>& vertices);
+
+	[[nodiscard]] Statistics const& statistics() const;
+
+private:
+	std::size_t plan(TessellationBatch const& batch);
+	std::size_t tessellate_items(TessellationBatch const& batch, std::byte* vertices);
+	void tessellate_range(TessellationBatch const& batch, std::size_t begin, std::size_t end,
+		std::byte* vertices, ElementBuffer::Index* indices) const;
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_TESSELLATION_HPP
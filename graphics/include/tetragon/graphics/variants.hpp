@@ -0,0 +1,84 @@
+#ifndef TETRAGON_GRAPHICS_VARIANTS_HPP
+#define TETRAGON_GRAPHICS_VARIANTS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "shaders.hpp"
+
+namespace tetragon::graphics {
+
+// Resolves `#include "name"` directives against sources registered by
+// name. Every file is included at most once per processed source.
+class ShaderPreprocessor final {
+	static constexpr uint MAX_INCLUDE_DEPTH = 32;
+
+	std::unordered_map<std::string, std::string> m_includes;
+
+public:
+	ShaderPreprocessor& add_include(std::string name, std::string source);
+	[[nodiscard]] bool has_include(std::string const& name) const;
+
+	[[nodiscard]] std::string process(std::string_view source) const;
+
+private:
+	void process(std::string_view source, std::string& output,
+		std::vector<std::string_view>& included, uint depth) const;
+};
+
+// Set of enabled shader features, one bit per feature registered in
+// ShaderVariants.
+class ShaderVariantKey final {
+	std::uint64_t m_bits = 0;
+
+public:
+	static constexpr uint MAX_FEATURES = 64;
+
+	constexpr ShaderVariantKey() = default;
+	constexpr explicit ShaderVariantKey(const std::uint64_t bits): m_bits(bits) {}
+
+	[[nodiscard]] constexpr std::uint64_t bits() const { return m_bits; }
+	[[nodiscard]] constexpr bool has(const ShaderVariantKey features) const {
+		return (m_bits & features.m_bits) == features.m_bits;
+	}
+
+	constexpr ShaderVariantKey operator|(const ShaderVariantKey other) const {
+		return ShaderVariantKey(m_bits | other.m_bits);
+	}
+	constexpr ShaderVariantKey operator&(const ShaderVariantKey other) const {
+		return ShaderVariantKey(m_bits & other.m_bits);
+	}
+	constexpr bool operator==(ShaderVariantKey const&) const = default;
+};
+
+// Programs specialised from the same sources by a set of features. Each
+// feature is a define injected into every stage; variants are compiled the
+// first time they are requested and kept for the lifetime of the set.
+class ShaderVariants final {
+	std::vector<ShaderSource> m_sources;
+	std::vector<std::string> m_features;
+	ProgramBinaryCache* m_cache;
+	std::unordered_map<std::uint64_t, std::unique_ptr<ShaderProgram>> m_programs;
+
+public:
+	explicit ShaderVariants(std::vector<ShaderSource> sources,
+		ShaderPreprocessor const& preprocessor = {}, ProgramBinaryCache* cache = nullptr);
+	ShaderVariants(ShaderVariants const&) = delete;
+	ShaderVariants(ShaderVariants&&) = default;
+
+	ShaderVariantKey add_feature(std::string define);
+	[[nodiscard]] ShaderVariantKey feature(std::string_view define) const;
+
+	[[nodiscard]] ShaderProgram& get(ShaderVariantKey key);
+	[[nodiscard]] bool contains(ShaderVariantKey key) const;
+	[[nodiscard]] std::size_t size() const;
+	void clear();
+};
+
+} // tetragon::graphics
+
+#endif // TETRAGON_GRAPHICS_VARIANTS_HPP
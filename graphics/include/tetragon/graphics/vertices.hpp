@@ -2,20 +2,32 @@
 #define VERTICES_HPP
 
 #include <glad/glad.h>
+#include <concepts>
 #include <string>
 #include <memory>
+#include <span>
+#include <ranges>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "definitions.hpp"
 
 namespace tetragon::graphics {
 
     class VertexBuffer;
+    class StreamingStorage;
+    class StagingAllocator;
+    class ElementBuffer;
 
-    struct Vertex {
-        [[nodiscard]] const void* vertex_data() const;
-        [[nodiscard]] std::size_t vertex_size() const;
-    protected:
-        Vertex() = default;
+    template<class T>
+    struct attribute_traits;
+
+    template<class T>
+    concept IsVertex = requires(T const& vertex) {
+        { vertex.vertex_data() } -> std::convertible_to<const void*>;
+        { vertex.vertex_size() } -> std::convertible_to<std::size_t>;
     };
 
     class VertexAttribute {
@@ -24,16 +36,22 @@ namespace tetragon::graphics {
         const GLenum m_type;
         const bool m_normalized;
         const uint m_stride;
+        const uint m_offset;
+        const uint m_divisor;
 
     public:
         VertexAttribute(const char* name, uint size, GLenum type,
-                bool normalized, uint stride);
+                bool normalized, uint stride, uint offset = 0, uint divisor = 0);
 
         [[nodiscard]] const char* name() const;
         [[nodiscard]] uint size() const;
         [[nodiscard]] GLenum type() const;
         [[nodiscard]] bool normalized() const;
         [[nodiscard]] uint stride() const;
+        [[nodiscard]] uint offset() const;
+        [[nodiscard]] uint divisor() const;
+
+        [[nodiscard]] VertexAttribute with_divisor(uint divisor) const;
 
         class Builder {
             const char* m_name = nullptr;
@@ -41,12 +59,24 @@ namespace tetragon::graphics {
             GLenum m_type = 0;
             bool m_normalized = false;
             uint m_stride = 0;
+            uint m_offset = 0;
+            uint m_divisor = 0;
         public:
             Builder& set_name(const char* name);
             Builder& set_size(uint size);
             Builder& set_type(GLenum type);
             Builder& set_normalized(bool normalized);
             Builder& set_stride(uint stride);
+            Builder& set_offset(uint offset);
+            Builder& set_divisor(uint divisor);
+
+            // Takes size, type and normalization from the attribute_traits
+            // of T, e.g. a Vector3 or one of the packed formats.
+            template<class T>
+            Builder& set_format() {
+                using traits = attribute_traits<T>;
+                return set_size(traits::size).set_type(traits::type).set_normalized(traits::normalized);
+            }
 
             [[nodiscard]] VertexAttribute build() const;
         };
@@ -62,22 +92,43 @@ namespace tetragon::graphics {
     private:
         using byte = char;
 
-        static constexpr size_t DEFAULT_BUFFER_SIZE = 8;
+        static constexpr uint FLUSH_MERGE_GAP = 256;
 
-        const GLObject m_object;
+        struct DirtyRange {
+            uint begin, end;
+        };
+
+        struct AttributeBinding {
+            uint location;
+            VertexAttribute attribute;
+            GLObject vertexArray;
+        };
+
+        GLObject m_object = 0;
         const std::size_t m_vertexSize;
+        std::unique_ptr<StreamingStorage> m_stream;
+        StagingAllocator* const m_allocator;
 
         byte* m_buffer;
-        byte* m_ptr;
         uint m_size = 0;
-        uint m_maxSize = DEFAULT_BUFFER_SIZE * m_vertexSize;
+        uint m_maxSize;
+
+        uint m_gpuSize = 0;
+        std::vector<DirtyRange> m_dirty;
+        std::vector<AttributeBinding> m_attributes;
 
         std::string m_name;
         Usage m_usage;
 
     public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 8;
+
         explicit VertexBuffer(std::size_t vertexSize);
         VertexBuffer(std::size_t vertexSize, Usage usage);
+        // Staging memory for initialCapacity vertices is taken from allocator,
+        // which has to outlive the buffer.
+        VertexBuffer(std::size_t vertexSize, Usage usage, std::size_t initialCapacity,
+                StagingAllocator& allocator);
         virtual ~VertexBuffer();
 
         [[nodiscard]] Usage usage() const;
@@ -85,18 +136,93 @@ namespace tetragon::graphics {
 
         [[nodiscard]] std::size_t size() const;
         [[nodiscard]] std::size_t vertex_size() const;
+        [[nodiscard]] uint vertex_count() const;
+        [[nodiscard]] uint first_vertex() const;
+        [[nodiscard]] bool is_streaming() const;
 
-        void bind() const;
+        void bind();
+        void flush();
+        void begin_frame();
+        void end_frame();
         void add_attribute(VertexAttribute const& attribute);
 
-        template<class T> requires std::is_base_of_v<Vertex, T>
+        template<class Layout>
+        void add_layout(const uint divisor = 0) {
+            if (Layout::stride != m_vertexSize) {
+                layout_mismatch(Layout::stride);
+            }
+            for (VertexAttribute const& attribute : Layout::attributes()) {
+                add_attribute(attribute.with_divisor(divisor));
+            }
+        }
+
+        void reserve(std::size_t vertexCount);
+        void clear();
+        [[nodiscard]] bool is_dirty() const;
+
+        template<IsVertex T>
         void buffer(T const& vertex) {
             buffer(vertex.vertex_data(), vertex.vertex_size());
         }
 
+        template<class T> requires std::is_trivially_copyable_v<T>
+        void buffer(std::span<const T> vertices) {
+            buffer_bulk(vertices.data(), vertices.size_bytes());
+        }
+
+        template<std::ranges::input_range R>
+            requires std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+                && (!std::is_same_v<std::remove_cvref_t<R>, std::span<const std::ranges::range_value_t<R>>>)
+        void buffer(R&& vertices) {
+            using T = std::ranges::range_value_t<R>;
+            if constexpr (std::ranges::contiguous_range<R>) {
+                buffer(std::span<const T>(std::ranges::data(vertices), std::ranges::size(vertices)));
+            } else {
+                if constexpr (std::ranges::sized_range<R>) {
+                    ensure_capacity(std::ranges::size(vertices) * sizeof(T));
+                }
+                const uint begin = m_size;
+                for (T const& vertex : vertices) {
+                    append(&vertex, sizeof(T));
+                }
+                commit_bulk(begin);
+            }
+        }
+
+        template<std::input_iterator It, std::sentinel_for<It> S>
+        void buffer(It first, S last) {
+            buffer(std::ranges::subrange(first, last));
+        }
+
+        // Appends vertexCount uninitialized vertices and returns their
+        // staging memory, so producers can write vertices in place.
+        std::span<std::byte> stage(std::size_t vertexCount);
+
+        template<IsVertex T>
+        void update(const std::size_t index, T const& vertex) {
+            update(index * m_vertexSize, vertex.vertex_data(), vertex.vertex_size());
+        }
+
+        template<class T> requires std::is_trivially_copyable_v<T>
+        void update(const std::size_t index, std::span<const T> vertices) {
+            update(index * m_vertexSize, vertices.data(), vertices.size_bytes());
+        }
+
     private:
         void buffer(const void* ptr, unsigned long size);
-        void ensure_capacity(uint additionalSize);
+        void buffer_bulk(const void* ptr, std::size_t size);
+        void commit_bulk(uint begin);
+        void append(const void* ptr, std::size_t size);
+        void update(std::size_t offset, const void* ptr, std::size_t size);
+        void mark_dirty(uint begin, uint end);
+        [[noreturn]] void layout_mismatch(std::size_t stride) const;
+        void create_storage();
+        void release_storage();
+        void apply_attributes();
+        [[nodiscard]] byte* storage() const;
+        [[nodiscard]] bool is_persistent() const;
+        void reallocate(std::size_t maxSize);
+        void ensure_capacity(std::size_t additionalSize);
     };
 
     class VertexArray final {
@@ -106,6 +232,49 @@ namespace tetragon::graphics {
         virtual ~VertexArray();
 
         void bind() const;
+
+        void draw_arrays(uint first, uint count, GLenum mode = GL_TRIANGLES) const;
+        void draw_elements(ElementBuffer& elements, GLenum mode = GL_TRIANGLES, int baseVertex = 0) const;
+
+        void draw_instanced(uint first, uint count, uint instanceCount, GLenum mode = GL_TRIANGLES) const;
+        void draw_elements_instanced(ElementBuffer& elements, uint instanceCount,
+                GLenum mode = GL_TRIANGLES, int baseVertex = 0) const;
+    };
+
+    // Per-instance attributes are read from offset 0, and base instances need
+    // GL 4.2, so streamed (ring buffered) usage is rejected.
+    class InstanceBuffer final {
+        VertexBuffer m_buffer;
+        const uint m_divisor;
+    public:
+        explicit InstanceBuffer(std::size_t instanceSize);
+        InstanceBuffer(std::size_t instanceSize, VertexBuffer::Usage usage, uint divisor = 1);
+
+        [[nodiscard]] VertexBuffer& vertices();
+        [[nodiscard]] uint divisor() const;
+        [[nodiscard]] uint instance_count() const;
+
+        void bind();
+        void flush();
+        void clear();
+        void reserve(std::size_t instanceCount);
+
+        void add_attribute(VertexAttribute const& attribute);
+
+        template<class Layout>
+        void add_layout() {
+            m_buffer.add_layout<Layout>(m_divisor);
+        }
+
+        template<class... Args>
+        void buffer(Args&&... args) {
+            m_buffer.buffer(std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        void update(Args&&... args) {
+            m_buffer.update(std::forward<Args>(args)...);
+        }
     };
 } // tetragon::graphics
 
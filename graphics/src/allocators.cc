@@ -0,0 +1,223 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "allocators.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	std::size_t align_up(const std::size_t size) {
+		return (size + StagingAllocator::ALIGNMENT - 1) & ~(StagingAllocator::ALIGNMENT - 1);
+	}
+}
+
+StagingAllocator& StagingAllocator::heap() {
+	static HeapAllocator allocator;
+	return allocator;
+}
+
+void* StagingAllocator::allocate(const std::size_t size) {
+	void* pointer = do_allocate(size);
+	m_statistics.allocations++;
+	m_statistics.allocatedBytes += size;
+	m_statistics.liveBytes += size;
+	m_statistics.peakBytes = std::max(m_statistics.peakBytes, m_statistics.liveBytes);
+	return pointer;
+}
+
+void StagingAllocator::deallocate(void* pointer, const std::size_t size) {
+	if (pointer == nullptr) return;
+	do_deallocate(pointer, size);
+	m_statistics.deallocations++;
+	m_statistics.liveBytes -= size;
+}
+
+void* StagingAllocator::reallocate(void* pointer, const std::size_t size, const std::size_t usedSize,
+		const std::size_t newSize) {
+	if (pointer == nullptr) return allocate(newSize);
+	if (newSize > size && do_expand(pointer, size, newSize)) {
+		m_statistics.expansions++;
+		m_statistics.allocatedBytes += newSize - size;
+		m_statistics.liveBytes += newSize - size;
+		m_statistics.peakBytes = std::max(m_statistics.peakBytes, m_statistics.liveBytes);
+		return pointer;
+	}
+	void* expanded = allocate(newSize);
+	memcpy(expanded, pointer, std::min(usedSize, newSize));
+	deallocate(pointer, size);
+	return expanded;
+}
+
+StagingAllocator::Statistics const& StagingAllocator::statistics() const {
+	return m_statistics;
+}
+
+void StagingAllocator::reset_statistics() {
+	const std::size_t liveBytes = m_statistics.liveBytes;
+	const std::size_t reservedBytes = m_statistics.reservedBytes;
+	m_statistics = {};
+	m_statistics.liveBytes = liveBytes;
+	m_statistics.peakBytes = liveBytes;
+	m_statistics.reservedBytes = reservedBytes;
+}
+
+bool StagingAllocator::do_expand(void*, std::size_t, std::size_t) {
+	return false;
+}
+
+void StagingAllocator::count_system_allocation(const std::size_t size) {
+	m_statistics.systemAllocations++;
+	m_statistics.reservedBytes += size;
+}
+
+void StagingAllocator::count_system_release(const std::size_t size) {
+	m_statistics.reservedBytes -= size;
+}
+
+void* StagingAllocator::system_allocate(const std::size_t size) {
+	return ::operator new(size, std::align_val_t { ALIGNMENT });
+}
+
+void StagingAllocator::system_deallocate(void* pointer) {
+	::operator delete(pointer, std::align_val_t { ALIGNMENT });
+}
+
+void* HeapAllocator::do_allocate(const std::size_t size) {
+	count_system_allocation(size);
+	return system_allocate(size);
+}
+
+void HeapAllocator::do_deallocate(void* pointer, const std::size_t size) {
+	count_system_release(size);
+	system_deallocate(pointer);
+}
+
+LinearArena::LinearArena(const std::size_t blockSize):
+		m_blockSize(align_up(blockSize)) {
+	if (blockSize == 0) {
+		spdlog::error("Failed to create a linear arena with empty blocks");
+		throw std::invalid_argument("Linear arena block size must be positive");
+	}
+}
+
+LinearArena::~LinearArena() {
+	for (Block const& block : m_blocks) {
+		system_deallocate(block.data);
+	}
+}
+
+void LinearArena::reset() {
+	m_block = 0;
+	m_offset = 0;
+	m_last = nullptr;
+}
+
+std::size_t LinearArena::used() const {
+	std::size_t used = m_offset;
+	for (std::size_t i = 0; i < m_block && i < m_blocks.size(); i++) {
+		used += m_blocks[i].size;
+	}
+	return used;
+}
+
+void* LinearArena::do_allocate(const std::size_t size) {
+	const std::size_t aligned = align_up(size);
+	while (m_block < m_blocks.size() && m_offset + aligned > m_blocks[m_block].size) {
+		m_block++;
+		m_offset = 0;
+	}
+	if (m_block == m_blocks.size()) {
+		const std::size_t blockSize = std::max(m_blockSize, aligned);
+		m_blocks.push_back({ static_cast<std::byte*>(system_allocate(blockSize)), blockSize });
+		count_system_allocation(blockSize);
+	}
+	m_last = m_blocks[m_block].data + m_offset;
+	m_offset += aligned;
+	return m_last;
+}
+
+void LinearArena::do_deallocate(void* pointer, std::size_t) {
+	if (pointer != m_last) return;
+	m_offset = m_last - m_blocks[m_block].data;
+	m_last = nullptr;
+}
+
+bool LinearArena::do_expand(void* pointer, std::size_t, const std::size_t newSize) {
+	if (pointer != m_last) return false;
+	const std::size_t offset = m_last - m_blocks[m_block].data;
+	if (offset + align_up(newSize) > m_blocks[m_block].size) return false;
+	m_offset = offset + align_up(newSize);
+	return true;
+}
+
+PoolAllocator::~PoolAllocator() {
+	for (SizeClass const& sizeClass : m_classes) {
+		for (std::byte* slab : sizeClass.slabs) {
+			system_deallocate(slab);
+		}
+	}
+}
+
+void PoolAllocator::trim() {
+	for (std::size_t i = 0; i < CLASS_COUNT; i++) {
+		SizeClass& sizeClass = m_classes[i];
+		const std::size_t perSlab = slab_size(i) / (MIN_CLASS_SIZE << i);
+		if (sizeClass.free.size() != sizeClass.slabs.size() * perSlab) continue;
+		for (std::byte* slab : sizeClass.slabs) {
+			system_deallocate(slab);
+			count_system_release(slab_size(i));
+		}
+		sizeClass.slabs.clear();
+		sizeClass.free.clear();
+	}
+}
+
+void* PoolAllocator::do_allocate(const std::size_t size) {
+	if (size > MAX_CLASS_SIZE) {
+		count_system_allocation(size);
+		return system_allocate(size);
+	}
+	const std::size_t index = class_index(size);
+	SizeClass& sizeClass = m_classes[index];
+	if (sizeClass.free.empty()) {
+		const std::size_t classSize = MIN_CLASS_SIZE << index;
+		const std::size_t slabSize = slab_size(index);
+		auto* slab = static_cast<std::byte*>(system_allocate(slabSize));
+		count_system_allocation(slabSize);
+		sizeClass.slabs.push_back(slab);
+		for (std::size_t offset = slabSize; offset >= classSize; offset -= classSize) {
+			sizeClass.free.push_back(slab + offset - classSize);
+		}
+	}
+	std::byte* block = sizeClass.free.back();
+	sizeClass.free.pop_back();
+	return block;
+}
+
+void PoolAllocator::do_deallocate(void* pointer, const std::size_t size) {
+	if (size > MAX_CLASS_SIZE) {
+		count_system_release(size);
+		system_deallocate(pointer);
+		return;
+	}
+	m_classes[class_index(size)].free.push_back(static_cast<std::byte*>(pointer));
+}
+
+bool PoolAllocator::do_expand(void*, const std::size_t size, const std::size_t newSize) {
+	return size <= MAX_CLASS_SIZE && newSize <= MAX_CLASS_SIZE && class_index(size) == class_index(newSize);
+}
+
+std::size_t PoolAllocator::class_index(const std::size_t size) {
+	const std::size_t rounded = std::bit_ceil(std::max(size, MIN_CLASS_SIZE));
+	return std::countr_zero(rounded) - std::countr_zero(MIN_CLASS_SIZE);
+}
+
+std::size_t PoolAllocator::slab_size(const std::size_t classIndex) {
+	return std::max(SLAB_SIZE, MIN_CLASS_SIZE << classIndex);
+}
+
+} // tetragon::graphics
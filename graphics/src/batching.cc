@@ -0,0 +1,89 @@
+#include <spdlog/spdlog.h>
+
+#include "batching.hpp"
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+ShapeBatcher::ShapeBatcher():
+		m_buffer(sizeof(Vector3), VertexBuffer::Usage::STREAM) {
+}
+
+std::size_t ShapeBatcher::shape_count() const {
+	return m_shapeCount;
+}
+
+std::size_t ShapeBatcher::group_count() const {
+	return m_groups.size();
+}
+
+void ShapeBatcher::submit(ShaderProgram& program, Shape const& shape) {
+	group(program).shapes.push_back(&shape);
+	m_shapeCount++;
+}
+
+void ShapeBatcher::submit(ShaderProgram& program, ShapeStore const& store) {
+	group(program).stores.push_back(&store);
+	m_shapeCount += store.triangle_count() + store.square_count();
+}
+
+void ShapeBatcher::submit(ShaderProgram& program, const std::span<const Shape* const> shapes) {
+	for (const Shape* shape : shapes) {
+		submit(program, *shape);
+	}
+}
+
+ShapeBatcher::Group& ShapeBatcher::group(ShaderProgram& program) {
+	for (auto const& group : m_groups) {
+		if (group->program == &program) {
+			return *group;
+		}
+	}
+
+	auto group = std::make_unique<Group>(&program);
+	ShaderProgram* boundProgram = ShaderProgram::get_bound_instance();
+	GLStateCache& state = GLStateCache::current();
+	const GLObject boundArray = state.vertex_array();
+
+	group->array.bind();
+	program.bind();
+	for (VertexAttribute const& attribute : PositionLayout::attributes()) {
+		m_buffer.add_attribute(attribute);
+	}
+	if (boundProgram != nullptr && boundProgram != &program) {
+		boundProgram->bind();
+	}
+	state.bind_vertex_array(boundArray);
+
+	spdlog::info("Created shape batch group #{}", m_groups.size());
+	m_groups.push_back(std::move(group));
+	return *m_groups.back();
+}
+
+void ShapeBatcher::draw(const GLenum mode) {
+	m_buffer.begin_frame();
+	for (auto const& group : m_groups) {
+		group->first = m_buffer.vertex_count();
+		for (const Shape* shape : group->shapes) {
+			shape->buffer_to(m_buffer);
+		}
+		for (const ShapeStore* store : group->stores) {
+			store->upload(m_buffer);
+		}
+		group->count = m_buffer.vertex_count() - group->first;
+		group->shapes.clear();
+		group->stores.clear();
+	}
+	m_buffer.flush();
+
+	const uint firstVertex = m_buffer.first_vertex();
+	for (auto const& group : m_groups) {
+		if (group->count == 0) continue;
+		group->program->bind();
+		group->array.draw_arrays(firstVertex + group->first, group->count, mode);
+	}
+	m_buffer.end_frame();
+	m_shapeCount = 0;
+}
+
+} // tetragon::graphics
@@ -0,0 +1,160 @@
+#include <spdlog/spdlog.h>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "binaries.hpp"
+#include "reflection.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	std::string get_string(const GLenum name) {
+		const auto* value = reinterpret_cast<const char*>(glGetString(name));
+		return value != nullptr ? value : "";
+	}
+}
+
+ProgramBinaryCache::ProgramBinaryCache(std::filesystem::path directory):
+		m_directory(std::move(directory)),
+		m_supported(is_supported()) {
+	if (!m_supported) {
+		spdlog::warn("Program binaries are not supported by the driver, shader cache is disabled");
+		return;
+	}
+	const std::string driver = get_string(GL_VENDOR) + '\n' + get_string(GL_RENDERER) + '\n' + get_string(GL_VERSION);
+	m_driverHash = hash_name(driver);
+
+	std::error_code error;
+	std::filesystem::create_directories(m_directory, error);
+	if (error) {
+		spdlog::warn("Failed to create shader cache directory `{}`: {}", m_directory.string(), error.message());
+	}
+}
+
+bool ProgramBinaryCache::is_supported() {
+	if (!GLAD_GL_ARB_get_program_binary) return false;
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+std::filesystem::path ProgramBinaryCache::default_directory() {
+	return std::filesystem::temp_directory_path() / "tetragon" / "shaders";
+}
+
+bool ProgramBinaryCache::enabled() const {
+	return m_supported;
+}
+
+std::filesystem::path const& ProgramBinaryCache::directory() const {
+	return m_directory;
+}
+
+uint ProgramBinaryCache::hits() const {
+	return m_hits;
+}
+
+uint ProgramBinaryCache::misses() const {
+	return m_misses;
+}
+
+std::uint64_t ProgramBinaryCache::key(const std::uint64_t sourcesHash) const {
+	return combine_hash(m_driverHash, sourcesHash);
+}
+
+std::filesystem::path ProgramBinaryCache::path(const std::uint64_t key) const {
+	return m_directory / fmt::format("{:016x}.bin", key);
+}
+
+bool ProgramBinaryCache::load(const std::uint64_t key, const GLObject program) {
+	if (!m_supported) return false;
+	std::ifstream file(path(key), std::ios::binary);
+	if (!file) {
+		m_misses++;
+		return false;
+	}
+
+	// The header is checked against the file before the binary is allocated,
+	// so a corrupt length cannot cause a huge allocation
+	Header header {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	bool valid = file && header.magic == MAGIC && header.version == VERSION && header.key == key;
+	std::vector<char> binary;
+	if (valid) {
+		const std::streampos start = file.tellg();
+		file.seekg(0, std::ios::end);
+		const std::streamoff remaining = file.tellg() - start;
+		file.seekg(start);
+		valid = file && header.length > 0 && static_cast<std::streamoff>(header.length) <= remaining;
+	}
+	if (valid) {
+		binary.resize(header.length);
+		file.read(binary.data(), binary.size());
+		valid = static_cast<bool>(file);
+	}
+	if (!valid) {
+		spdlog::warn("Discarding malformed shader cache entry {:016x}", key);
+		m_misses++;
+		file.close();
+		remove(key);
+		return false;
+	}
+
+	glProgramBinary(program, header.format, binary.data(), header.length);
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		spdlog::info("Driver rejected cached shader program {:016x}, compiling from source", key);
+		m_misses++;
+		file.close();
+		remove(key);
+		return false;
+	}
+
+	spdlog::debug("Loaded shader program {:016x} from cache ({} bytes)", key, header.length);
+	m_hits++;
+	return true;
+}
+
+void ProgramBinaryCache::store(const std::uint64_t key, const GLObject program) const {
+	if (!m_supported) return;
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		spdlog::warn("Driver returned no binary for shader program {:016x}", key);
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+	const Header header { MAGIC, VERSION, key, format, static_cast<std::uint32_t>(length) };
+
+	const std::filesystem::path target = path(key);
+	std::filesystem::path temporary = target;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), length);
+		if (!file) {
+			spdlog::warn("Failed to write shader cache entry `{}`", temporary.string());
+			return;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, target, error);
+	if (error) {
+		spdlog::warn("Failed to store shader cache entry `{}`: {}", target.string(), error.message());
+		return;
+	}
+	spdlog::debug("Stored shader program {:016x} in cache ({} bytes)", key, length);
+}
+
+void ProgramBinaryCache::remove(const std::uint64_t key) const {
+	std::error_code error;
+	std::filesystem::remove(path(key), error);
+}
+
+} // tetragon::graphics
@@ -0,0 +1,76 @@
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "blocks.hpp"
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	GLObject create_uniform_buffer(std::string const& name, const uint binding, const std::size_t size) {
+		GLint maxBindings;
+		glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
+		if (binding >= static_cast<uint>(maxBindings)) {
+			spdlog::error("Uniform block `{}` uses binding {}, but only {} are available", name, binding, maxBindings);
+			throw std::out_of_range("Uniform block binding out of range");
+		}
+		GLObject buffer;
+		glGenBuffers(1, &buffer);
+		GLStateCache::current().bind_buffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		return buffer;
+	}
+}
+
+UniformBuffer::UniformBuffer(std::string name, const uint binding, const std::size_t size):
+		m_object(create_uniform_buffer(name, binding, size)),
+		m_name(std::move(name)),
+		m_binding(binding),
+		m_size(size) {
+	GLStateCache::current().bind_buffer_base(GL_UNIFORM_BUFFER, m_binding, m_object);
+}
+
+UniformBuffer::~UniformBuffer() {
+	GLStateCache::current().forget_buffer(m_object);
+	glDeleteBuffers(1, &m_object);
+}
+
+std::string const& UniformBuffer::name() const {
+	return m_name;
+}
+
+uint UniformBuffer::binding() const {
+	return m_binding;
+}
+
+std::size_t UniformBuffer::size() const {
+	return m_size;
+}
+
+bool UniformBuffer::attach(ShaderProgram& program) const {
+	const GLuint index = glGetUniformBlockIndex(program.m_object, m_name.c_str());
+	if (index == GL_INVALID_INDEX) {
+		spdlog::warn("Shader program {} has no uniform block `{}`", program.m_object, m_name);
+		return false;
+	}
+	GLint dataSize;
+	glGetActiveUniformBlockiv(program.m_object, index, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+	if (static_cast<std::size_t>(dataSize) > m_size) {
+		spdlog::error("Uniform block `{}` needs {} bytes in program {}, but its buffer has {}",
+			m_name, dataSize, program.m_object, m_size);
+		throw std::runtime_error("Uniform block layout mismatch");
+	}
+	glUniformBlockBinding(program.m_object, index, m_binding);
+	return true;
+}
+
+void UniformBuffer::bind() const {
+	GLStateCache::current().bind_buffer_base(GL_UNIFORM_BUFFER, m_binding, m_object);
+}
+
+void UniformBuffer::upload(const void* data, const std::size_t size) const {
+	GLStateCache::current().bind_buffer(GL_UNIFORM_BUFFER, m_object);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+}
+
+} // tetragon::graphics
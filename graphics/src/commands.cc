@@ -0,0 +1,169 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <iterator>
+
+#include "commands.hpp"
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	template<class Command>
+	Command read(const std::byte* data) {
+		Command command;
+		memcpy(&command, data, sizeof(Command));
+		return command;
+	}
+}
+
+CommandBuffer::CommandBuffer(const std::uint64_t order):
+		m_order(order) {
+}
+
+std::uint64_t CommandBuffer::order() const {
+	return m_order;
+}
+
+void CommandBuffer::set_order(const std::uint64_t order) {
+	m_order = order;
+}
+
+std::size_t CommandBuffer::count() const {
+	return m_count;
+}
+
+std::size_t CommandBuffer::size() const {
+	return m_data.size();
+}
+
+bool CommandBuffer::empty() const {
+	return m_count == 0;
+}
+
+void CommandBuffer::bind_program(ShaderProgram& program) {
+	record(CommandType::BIND_PROGRAM, BindProgram { &program });
+}
+
+void CommandBuffer::upload(const GLObject buffer, const std::size_t offset, const std::span<const std::byte> data) {
+	record(CommandType::UPLOAD, Upload { buffer, offset, data.size() }, data.data(), data.size());
+}
+
+void CommandBuffer::flush(VertexBuffer& buffer) {
+	record(CommandType::FLUSH_VERTICES, FlushVertices { &buffer });
+}
+
+void CommandBuffer::draw_arrays(VertexArray const& array, const uint first, const uint count,
+		const GLenum mode, const uint instances) {
+	record(CommandType::DRAW_ARRAYS, DrawArrays { &array, mode, first, count, instances });
+}
+
+void CommandBuffer::draw_elements(VertexArray const& array, ElementBuffer& elements,
+		const GLenum mode, const int baseVertex, const uint instances) {
+	record(CommandType::DRAW_ELEMENTS, DrawElements { &array, &elements, mode, baseVertex, instances });
+}
+
+void CommandBuffer::execute() const {
+	const std::byte* data = m_data.data();
+	const std::byte* end = data + m_data.size();
+	while (data < end) {
+		const auto header = read<Header>(data);
+		const std::byte* command = data + align(sizeof(Header));
+		switch (header.type) {
+			case CommandType::BIND_PROGRAM:
+				read<BindProgram>(command).program->bind();
+				break;
+			case CommandType::SET_UNIFORM: {
+				const auto setUniform = read<SetUniform>(command);
+				setUniform.setter(*setUniform.program, setUniform.location, command + align(sizeof(SetUniform)));
+				break;
+			}
+			case CommandType::UPLOAD: {
+				const auto upload = read<Upload>(command);
+				GLStateCache::current().bind_buffer(GL_COPY_WRITE_BUFFER, upload.buffer);
+				glBufferSubData(GL_COPY_WRITE_BUFFER, upload.offset, upload.size, command + align(sizeof(Upload)));
+				break;
+			}
+			case CommandType::UPDATE_VERTICES: {
+				const auto update = read<UpdateVertices>(command);
+				update.buffer->update(update.index,
+					std::span(command + align(sizeof(UpdateVertices)), update.size));
+				break;
+			}
+			case CommandType::FLUSH_VERTICES:
+				read<FlushVertices>(command).buffer->flush();
+				break;
+			case CommandType::DRAW_ARRAYS: {
+				const auto draw = read<DrawArrays>(command);
+				if (draw.instances == 1) {
+					draw.array->draw_arrays(draw.first, draw.count, draw.mode);
+				} else {
+					draw.array->draw_instanced(draw.first, draw.count, draw.instances, draw.mode);
+				}
+				break;
+			}
+			case CommandType::DRAW_ELEMENTS: {
+				const auto draw = read<DrawElements>(command);
+				if (draw.instances == 1) {
+					draw.array->draw_elements(*draw.elements, draw.mode, draw.baseVertex);
+				} else {
+					draw.array->draw_elements_instanced(*draw.elements, draw.instances, draw.mode, draw.baseVertex);
+				}
+				break;
+			}
+		}
+		data += header.size;
+	}
+}
+
+void CommandBuffer::clear() {
+	m_data.clear();
+	m_count = 0;
+}
+
+CommandBuffer& CommandQueue::acquire(const std::uint64_t order) {
+	std::lock_guard lock(m_mutex);
+	if (m_free.empty()) {
+		m_recording.push_back(std::make_unique<CommandBuffer>(order));
+	} else {
+		m_recording.push_back(std::move(m_free.back()));
+		m_free.pop_back();
+		m_recording.back()->set_order(order);
+	}
+	return *m_recording.back();
+}
+
+void CommandQueue::execute() {
+	std::vector<std::unique_ptr<CommandBuffer>> buffers;
+	{
+		std::lock_guard lock(m_mutex);
+		buffers.swap(m_recording);
+	}
+	std::ranges::stable_sort(buffers, {}, [](auto const& buffer) { return buffer->order(); });
+
+	m_statistics = { buffers.size(), 0, 0 };
+	try {
+		for (auto const& buffer : buffers) {
+			m_statistics.commands += buffer->count();
+			m_statistics.bytes += buffer->size();
+			buffer->execute();
+		}
+	} catch (...) {
+		recycle(buffers);
+		throw;
+	}
+	recycle(buffers);
+}
+
+void CommandQueue::recycle(std::vector<std::unique_ptr<CommandBuffer>>& buffers) {
+	for (auto const& buffer : buffers) {
+		buffer->clear();
+	}
+	std::lock_guard lock(m_mutex);
+	std::ranges::move(buffers, std::back_inserter(m_free));
+}
+
+CommandQueue::Statistics const& CommandQueue::statistics() const {
+	return m_statistics;
+}
+
+} // tetragon::graphics
@@ -0,0 +1,103 @@
+#include <spdlog/spdlog.h>
+#include <fmt/color.h>
+#include <algorithm>
+
+#include "elements.hpp"
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	GLObject create_element_buffer() {
+		GLObject buffer;
+		glGenBuffers(1, &buffer);
+		return buffer;
+	}
+}
+
+ElementBuffer::ElementBuffer(): ElementBuffer(VertexBuffer::Usage::STATIC) {}
+
+ElementBuffer::ElementBuffer(const VertexBuffer::Usage usage):
+		m_object(create_element_buffer()),
+		m_usage(usage) {
+}
+
+ElementBuffer::~ElementBuffer() {
+	GLStateCache::current().forget_buffer(m_object);
+	glDeleteBuffers(1, &m_object);
+}
+
+std::size_t ElementBuffer::count() const {
+	return m_indices.size();
+}
+
+ElementBuffer::IndexType ElementBuffer::index_type() const {
+	return m_type;
+}
+
+std::size_t ElementBuffer::index_size() const {
+	return m_type == IndexType::UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(Index);
+}
+
+void ElementBuffer::bind() {
+	GLStateCache::current().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_object);
+	flush();
+}
+
+void ElementBuffer::flush() {
+	if (!m_dirty) return;
+	m_dirty = false;
+
+	const IndexType type = m_maxIndex <= UINT16_MAX ? IndexType::UNSIGNED_SHORT : IndexType::UNSIGNED_INT;
+	const void* data = m_indices.data();
+	if (type == IndexType::UNSIGNED_SHORT) {
+		m_shortIndices.assign(m_indices.begin(), m_indices.end());
+		data = m_shortIndices.data();
+	}
+	if (type != m_type) {
+		m_gpuSize = 0;
+		m_type = type;
+	}
+
+	const std::size_t size = m_indices.size() * index_size();
+	GLStateCache::current().bind_buffer(GL_COPY_WRITE_BUFFER, m_object);
+	if (size > m_gpuSize) {
+		m_gpuSize = std::max(size, m_indices.capacity() * index_size());
+		glBufferData(GL_COPY_WRITE_BUFFER, m_gpuSize, nullptr, (GLenum) m_usage);
+	}
+	glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+
+	spdlog::debug(" {}: flushed {} {}-bit indices", m_name, m_indices.size(), index_size() * 8);
+}
+
+void ElementBuffer::reserve(const std::size_t indexCount) {
+	m_indices.reserve(indexCount);
+}
+
+void ElementBuffer::clear() {
+	m_indices.clear();
+	m_maxIndex = 0;
+	m_dirty = true;
+}
+
+void ElementBuffer::buffer(const std::span<const Index> indices, const Index baseVertex) {
+	if (indices.empty()) return;
+	const std::size_t begin = m_indices.size();
+	m_indices.resize(begin + indices.size());
+	Index maxIndex = m_maxIndex;
+	for (std::size_t i = 0; i < indices.size(); i++) {
+		const Index index = indices[i] + baseVertex;
+		m_indices[begin + i] = index;
+		maxIndex = std::max(maxIndex, index);
+	}
+	m_maxIndex = maxIndex;
+	m_dirty = true;
+	if (!spdlog::should_log(spdlog::level::debug)) return;
+
+	spdlog::debug(" {}: {}",
+		m_name,
+		fmt::format(fg(fmt::color::green_yellow), "+{} indices", indices.size())
+	);
+}
+
+} // tetragon::graphics
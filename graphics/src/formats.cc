@@ -0,0 +1,260 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "formats.hpp"
+#include "simd.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	static_assert(sizeof(Half3) == 6 && sizeof(Half4) == 8);
+	static_assert(sizeof(Snorm16x3) == 6 && sizeof(Snorm16x4) == 8);
+	static_assert(sizeof(Unorm8x4) == 4 && sizeof(PackedNormal) == 4);
+
+	constexpr float SNORM16_MAX = 32767;
+	constexpr float UNORM8_MAX = 255;
+	constexpr float SNORM10_MAX = 511;
+
+	// Rounds to nearest even under the default rounding mode, like cvtps2dq.
+	// NaN fails the comparison and maps to min, like maxps.
+	std::int32_t quantize(const float value, const float min, const float scale) {
+		return static_cast<std::int32_t>(std::lrint(std::min(value > min ? value : min, 1.f) * scale));
+	}
+
+	std::int16_t to_snorm16(const float value) {
+		return static_cast<std::int16_t>(quantize(value, -1, SNORM16_MAX));
+	}
+
+	std::uint8_t to_unorm8(const float value) {
+		return static_cast<std::uint8_t>(quantize(value, 0, UNORM8_MAX));
+	}
+
+	float from_snorm(const std::int32_t value, const float scale) {
+		return std::max(static_cast<float>(value) / scale, -1.f);
+	}
+
+	void check_sizes(const char* kernel, const std::size_t input, const std::size_t output) {
+		if (input != output) {
+			spdlog::error("Kernel `{}` got {} inputs but room for {} results", kernel, input, output);
+			throw std::invalid_argument("Kernel input and output sizes differ");
+		}
+	}
+
+#ifdef TETRAGON_SIMD_SSE
+	__m128 load3(Vector3 const& vector) {
+		return _mm_setr_ps(vector.x, vector.y, vector.z, 0);
+	}
+
+	__m128i quantize4(const __m128 values, const float min, const float scale) {
+		const __m128 clamped = _mm_min_ps(_mm_max_ps(values, _mm_set1_ps(min)), _mm_set1_ps(1));
+		return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(scale)));
+	}
+
+	__m128i snorm16x4(const __m128 values) {
+		const __m128i quantized = quantize4(values, -1, SNORM16_MAX);
+		return _mm_packs_epi32(quantized, quantized);
+	}
+#endif
+}
+
+std::uint16_t float_to_half(const float value) {
+	const auto bits = std::bit_cast<std::uint32_t>(value);
+	const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+	std::uint32_t magnitude = bits & 0x7fffffff;
+
+	if (magnitude >= 0x7f800000) {
+		// Infinity stays infinity, NaNs stay quiet NaNs
+		return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+	}
+	if (magnitude >= 0x477ff000) {
+		// Rounds to a value above the largest half, 65504
+		return sign | 0x7c00;
+	}
+	if (magnitude < 0x38800000) {
+		// Subnormal half: count multiples of 2^-24, which is exact in float
+		const float scaled = std::bit_cast<float>(magnitude) * 16777216.f;
+		return sign | static_cast<std::uint16_t>(std::lrint(scaled));
+	}
+	magnitude -= 0x38000000;
+	magnitude += 0xfff + ((magnitude >> 13) & 1);
+	return sign | static_cast<std::uint16_t>(magnitude >> 13);
+}
+
+float half_to_float(const std::uint16_t half) {
+	const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+	const std::uint32_t exponent = (half >> 10) & 0x1f;
+	const std::uint32_t mantissa = half & 0x3ff;
+
+	if (exponent == 0) {
+		const float value = static_cast<float>(mantissa) / 16777216.f;
+		return sign != 0 ? -value : value;
+	}
+	if (exponent == 0x1f) {
+		return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+	}
+	return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+Half3 pack_half(const Vector3 vector) {
+	return {{ float_to_half(vector.x), float_to_half(vector.y), float_to_half(vector.z) }};
+}
+
+Half4 pack_half(const Vector4 vector) {
+	return {{ float_to_half(vector.x), float_to_half(vector.y), float_to_half(vector.z), float_to_half(vector.w) }};
+}
+
+Snorm16x3 pack_snorm16(const Vector3 vector) {
+	return {{ to_snorm16(vector.x), to_snorm16(vector.y), to_snorm16(vector.z) }};
+}
+
+Snorm16x4 pack_snorm16(const Vector4 vector) {
+	return {{ to_snorm16(vector.x), to_snorm16(vector.y), to_snorm16(vector.z), to_snorm16(vector.w) }};
+}
+
+Unorm8x4 pack_unorm8(const Vector4 vector) {
+	return {{ to_unorm8(vector.x), to_unorm8(vector.y), to_unorm8(vector.z), to_unorm8(vector.w) }};
+}
+
+PackedNormal pack_normal(const Vector3 normal, const float w) {
+	const auto bits10 = [](const float value) {
+		return static_cast<std::uint32_t>(quantize(value, -1, SNORM10_MAX)) & 0x3ff;
+	};
+	const auto bits2 = static_cast<std::uint32_t>(quantize(w, -1, 1)) & 0x3;
+	return { bits10(normal.x) | bits10(normal.y) << 10 | bits10(normal.z) << 20 | bits2 << 30 };
+}
+
+Vector3 unpack(const Half3 vector) {
+	return { half_to_float(vector.values[0]), half_to_float(vector.values[1]), half_to_float(vector.values[2]) };
+}
+
+Vector4 unpack(const Half4 vector) {
+	return {
+		half_to_float(vector.values[0]), half_to_float(vector.values[1]),
+		half_to_float(vector.values[2]), half_to_float(vector.values[3])
+	};
+}
+
+Vector3 unpack(const Snorm16x3 vector) {
+	return {
+		from_snorm(vector.values[0], SNORM16_MAX),
+		from_snorm(vector.values[1], SNORM16_MAX),
+		from_snorm(vector.values[2], SNORM16_MAX)
+	};
+}
+
+Vector4 unpack(const Snorm16x4 vector) {
+	return {
+		from_snorm(vector.values[0], SNORM16_MAX), from_snorm(vector.values[1], SNORM16_MAX),
+		from_snorm(vector.values[2], SNORM16_MAX), from_snorm(vector.values[3], SNORM16_MAX)
+	};
+}
+
+Vector4 unpack(const Unorm8x4 vector) {
+	return {
+		vector.values[0] / UNORM8_MAX, vector.values[1] / UNORM8_MAX,
+		vector.values[2] / UNORM8_MAX, vector.values[3] / UNORM8_MAX
+	};
+}
+
+Vector4 unpack(const PackedNormal normal) {
+	// Shifting the field to the top and back sign-extends it
+	const auto field = [&normal](const uint shift, const uint width) {
+		return static_cast<std::int32_t>(normal.bits << (32 - shift - width)) >> (32 - width);
+	};
+	return {
+		from_snorm(field(0, 10), SNORM10_MAX),
+		from_snorm(field(10, 10), SNORM10_MAX),
+		from_snorm(field(20, 10), SNORM10_MAX),
+		from_snorm(field(30, 2), 1)
+	};
+}
+
+namespace kernels {
+
+	void compress(const std::span<const Vector3> vectors, const std::span<Half3> result) {
+		check_sizes("compress", vectors.size(), result.size());
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+#ifdef TETRAGON_SIMD_F16C
+			const __m128i halves = _mm_cvtps_ph(load3(vectors[i]), _MM_FROUND_TO_NEAREST_INT);
+			memcpy(&result[i], &halves, sizeof(Half3));
+#else
+			result[i] = pack_half(vectors[i]);
+#endif
+		}
+	}
+
+	void compress(const std::span<const Vector4> vectors, const std::span<Half4> result) {
+		check_sizes("compress", vectors.size(), result.size());
+		std::size_t i = 0;
+#ifdef TETRAGON_SIMD_F16C
+		for (; i + 2 <= vectors.size(); i += 2) {
+			const __m256 pair = _mm256_loadu_ps(&vectors[i].x);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&result[i]), _mm256_cvtps_ph(pair, _MM_FROUND_TO_NEAREST_INT));
+		}
+#endif
+		for (; i < vectors.size(); i++) {
+			result[i] = pack_half(vectors[i]);
+		}
+	}
+
+	void compress(const std::span<const Vector3> vectors, const std::span<Snorm16x3> result) {
+		check_sizes("compress", vectors.size(), result.size());
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+#ifdef TETRAGON_SIMD_SSE
+			const __m128i packed = snorm16x4(load3(vectors[i]));
+			memcpy(&result[i], &packed, sizeof(Snorm16x3));
+#else
+			result[i] = pack_snorm16(vectors[i]);
+#endif
+		}
+	}
+
+	void compress(const std::span<const Vector4> vectors, const std::span<Snorm16x4> result) {
+		check_sizes("compress", vectors.size(), result.size());
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+#ifdef TETRAGON_SIMD_SSE
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&result[i]), snorm16x4(_mm_load_ps(&vectors[i].x)));
+#else
+			result[i] = pack_snorm16(vectors[i]);
+#endif
+		}
+	}
+
+	void compress(const std::span<const Vector4> vectors, const std::span<Unorm8x4> result) {
+		check_sizes("compress", vectors.size(), result.size());
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+#ifdef TETRAGON_SIMD_SSE
+			const __m128i quantized = quantize4(_mm_load_ps(&vectors[i].x), 0, UNORM8_MAX);
+			const __m128i words = _mm_packs_epi32(quantized, quantized);
+			const std::int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+			memcpy(&result[i], &bytes, sizeof(Unorm8x4));
+#else
+			result[i] = pack_unorm8(vectors[i]);
+#endif
+		}
+	}
+
+	void compress(const std::span<const Vector3> normals, const std::span<PackedNormal> result) {
+		check_sizes("compress", normals.size(), result.size());
+		for (std::size_t i = 0; i < normals.size(); i++) {
+#ifdef TETRAGON_SIMD_SSE
+			alignas(16) std::int32_t fields[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(fields), quantize4(load3(normals[i]), -1, SNORM10_MAX));
+			result[i] = {
+				(static_cast<std::uint32_t>(fields[0]) & 0x3ff)
+				| (static_cast<std::uint32_t>(fields[1]) & 0x3ff) << 10
+				| (static_cast<std::uint32_t>(fields[2]) & 0x3ff) << 20
+			};
+#else
+			result[i] = pack_normal(normals[i]);
+#endif
+		}
+	}
+
+} // kernels
+
+} // tetragon::graphics
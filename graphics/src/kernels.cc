@@ -0,0 +1,355 @@
+#include <spdlog/spdlog.h>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "kernels.hpp"
+#include "simd.hpp"
+
+namespace tetragon::graphics::kernels {
+
+namespace {
+	static_assert(sizeof(Vector4) == 4 * sizeof(float) && alignof(Vector4) == 16);
+	static_assert(sizeof(Vector3) == 3 * sizeof(float));
+	static_assert(alignof(Matrix4) == 16);
+
+	void check_sizes(const char* kernel, const std::size_t input, const std::size_t output) {
+		if (input != output) {
+			spdlog::error("Kernel `{}` got {} inputs but room for {} results", kernel, input, output);
+			throw std::invalid_argument("Kernel input and output sizes differ");
+		}
+	}
+
+	float* floats(Vector4* vectors) {
+		return &vectors->x;
+	}
+
+	const float* floats(const Vector4* vectors) {
+		return &vectors->x;
+	}
+
+#ifdef TETRAGON_SIMD_SSE
+	__m128 multiply_add(const __m128 a, const __m128 b, const __m128 c) {
+#	ifdef TETRAGON_SIMD_FMA
+		return _mm_fmadd_ps(a, b, c);
+#	else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+#	endif
+	}
+
+#	ifdef TETRAGON_SIMD_AVX2
+	__m256 multiply_add(const __m256 a, const __m256 b, const __m256 c) {
+#		ifdef TETRAGON_SIMD_FMA
+		return _mm256_fmadd_ps(a, b, c);
+#		else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#		endif
+	}
+#	endif
+
+	__m128 dot4(const __m128 a, const __m128 b) {
+		const __m128 product = _mm_mul_ps(a, b);
+		const __m128 shuffled = _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1));
+		const __m128 sums = _mm_add_ps(product, shuffled);
+		return _mm_add_ps(sums, _mm_movehl_ps(shuffled, sums));
+	}
+#endif
+}
+
+const char* backend() {
+#if defined(TETRAGON_SIMD_AVX2)
+	return "AVX2";
+#elif defined(TETRAGON_SIMD_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
+
+void add(const std::span<const Vector4> first, const std::span<const Vector4> second, const std::span<Vector4> result) {
+	check_sizes("add", first.size(), second.size());
+	check_sizes("add", first.size(), result.size());
+	const float* a = floats(first.data());
+	const float* b = floats(second.data());
+	float* out = floats(result.data());
+	const std::size_t count = first.size() * 4;
+	std::size_t i = 0;
+#if defined(TETRAGON_SIMD_AVX2)
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+	}
+#endif
+#if defined(TETRAGON_SIMD_SSE)
+	for (; i < count; i += 4) {
+		_mm_store_ps(out + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+	}
+#else
+	for (; i < count; i++) {
+		out[i] = a[i] + b[i];
+	}
+#endif
+}
+
+void scale(const std::span<const Vector4> vectors, const float factor, const std::span<Vector4> result) {
+	check_sizes("scale", vectors.size(), result.size());
+	const float* in = floats(vectors.data());
+	float* out = floats(result.data());
+	const std::size_t count = vectors.size() * 4;
+	std::size_t i = 0;
+#if defined(TETRAGON_SIMD_AVX2)
+	const __m256 factor8 = _mm256_set1_ps(factor);
+	for (; i + 8 <= count; i += 8) {
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), factor8));
+	}
+#endif
+#if defined(TETRAGON_SIMD_SSE)
+	const __m128 factor4 = _mm_set1_ps(factor);
+	for (; i < count; i += 4) {
+		_mm_store_ps(out + i, _mm_mul_ps(_mm_load_ps(in + i), factor4));
+	}
+#else
+	for (; i < count; i++) {
+		out[i] = in[i] * factor;
+	}
+#endif
+}
+
+void dot(const std::span<const Vector4> first, const std::span<const Vector4> second, const std::span<float> result) {
+	check_sizes("dot", first.size(), second.size());
+	check_sizes("dot", first.size(), result.size());
+	for (std::size_t i = 0; i < first.size(); i++) {
+#if defined(TETRAGON_SIMD_SSE)
+		result[i] = _mm_cvtss_f32(dot4(_mm_load_ps(floats(&first[i])), _mm_load_ps(floats(&second[i]))));
+#else
+		Vector4 const& a = first[i];
+		Vector4 const& b = second[i];
+		result[i] = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+#endif
+	}
+}
+
+void normalize(const std::span<const Vector4> vectors, const std::span<Vector4> result) {
+	check_sizes("normalize", vectors.size(), result.size());
+	for (std::size_t i = 0; i < vectors.size(); i++) {
+#if defined(TETRAGON_SIMD_SSE)
+		const __m128 vector = _mm_load_ps(floats(&vectors[i]));
+		const __m128 lengthSquared = dot4(vector, vector);
+		const __m128 length = _mm_sqrt_ps(_mm_shuffle_ps(lengthSquared, lengthSquared, 0));
+		const __m128 nonZero = _mm_cmpneq_ps(length, _mm_setzero_ps());
+		_mm_store_ps(floats(&result[i]), _mm_and_ps(_mm_div_ps(vector, length), nonZero));
+#else
+		Vector4 const& vector = vectors[i];
+		const float length = std::sqrt(vector.x * vector.x + vector.y * vector.y
+			+ vector.z * vector.z + vector.w * vector.w);
+		result[i] = length != 0 ? vector / length : Vector4 {};
+#endif
+	}
+}
+
+void transform(Matrix4 const& matrix, const std::span<const Vector4> vectors, const std::span<Vector4> result) {
+	check_sizes("transform", vectors.size(), result.size());
+	std::size_t i = 0;
+#if defined(TETRAGON_SIMD_AVX2)
+	const __m256 columns8[4] {
+		_mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.values)),
+		_mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.values + 4)),
+		_mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.values + 8)),
+		_mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix.values + 12))
+	};
+	// Each 128-bit lane holds one vector, so components broadcast per lane
+	for (; i + 2 <= vectors.size(); i += 2) {
+		const __m256 pair = _mm256_loadu_ps(floats(&vectors[i]));
+		__m256 out = _mm256_mul_ps(columns8[0], _mm256_permute_ps(pair, 0x00));
+		out = multiply_add(columns8[1], _mm256_permute_ps(pair, 0x55), out);
+		out = multiply_add(columns8[2], _mm256_permute_ps(pair, 0xAA), out);
+		out = multiply_add(columns8[3], _mm256_permute_ps(pair, 0xFF), out);
+		_mm256_storeu_ps(floats(&result[i]), out);
+	}
+#endif
+#if defined(TETRAGON_SIMD_SSE)
+	const __m128 columns[4] {
+		_mm_load_ps(matrix.values),
+		_mm_load_ps(matrix.values + 4),
+		_mm_load_ps(matrix.values + 8),
+		_mm_load_ps(matrix.values + 12)
+	};
+	for (; i < vectors.size(); i++) {
+		const __m128 vector = _mm_load_ps(floats(&vectors[i]));
+		__m128 out = _mm_mul_ps(columns[0], _mm_shuffle_ps(vector, vector, 0x00));
+		out = multiply_add(columns[1], _mm_shuffle_ps(vector, vector, 0x55), out);
+		out = multiply_add(columns[2], _mm_shuffle_ps(vector, vector, 0xAA), out);
+		out = multiply_add(columns[3], _mm_shuffle_ps(vector, vector, 0xFF), out);
+		_mm_store_ps(floats(&result[i]), out);
+	}
+#else
+	for (; i < vectors.size(); i++) {
+		const Vector4 vector = vectors[i];
+		const float components[4] { vector.x, vector.y, vector.z, vector.w };
+		float out[4] {};
+		for (uint column = 0; column < 4; column++) {
+			for (uint row = 0; row < 4; row++) {
+				out[row] += matrix(row, column) * components[column];
+			}
+		}
+		result[i] = Vector4 { out[0], out[1], out[2], out[3] };
+	}
+#endif
+}
+
+void transform_points(Matrix4 const& matrix, const std::span<const Vector3> points, const std::span<Vector3> result) {
+	check_sizes("transform_points", points.size(), result.size());
+#if defined(TETRAGON_SIMD_SSE)
+	const __m128 columns[4] {
+		_mm_load_ps(matrix.values),
+		_mm_load_ps(matrix.values + 4),
+		_mm_load_ps(matrix.values + 8),
+		_mm_load_ps(matrix.values + 12)
+	};
+	for (std::size_t i = 0; i < points.size(); i++) {
+		const Vector3 point = points[i];
+		__m128 out = multiply_add(columns[0], _mm_set1_ps(point.x), columns[3]);
+		out = multiply_add(columns[1], _mm_set1_ps(point.y), out);
+		out = multiply_add(columns[2], _mm_set1_ps(point.z), out);
+		float* destination = &result[i].x;
+		_mm_storel_pi(reinterpret_cast<__m64*>(destination), out);
+		_mm_store_ss(destination + 2, _mm_movehl_ps(out, out));
+	}
+#else
+	for (std::size_t i = 0; i < points.size(); i++) {
+		const Vector3 point = points[i];
+		result[i] = Vector3 {
+			matrix(0, 0) * point.x + matrix(0, 1) * point.y + matrix(0, 2) * point.z + matrix(0, 3),
+			matrix(1, 0) * point.x + matrix(1, 1) * point.y + matrix(1, 2) * point.z + matrix(1, 3),
+			matrix(2, 0) * point.x + matrix(2, 1) * point.y + matrix(2, 2) * point.z + matrix(2, 3)
+		};
+	}
+#endif
+}
+
+namespace {
+	void check_streams(const char* kernel, PositionStreams const& positions) {
+		check_sizes(kernel, positions.x.size(), positions.y.size());
+		check_sizes(kernel, positions.x.size(), positions.z.size());
+	}
+
+	// Transforms points [begin, end) of positions and hands each result to
+	// write(index, x, y, z). Full registers of points are transformed at once.
+	template<class Write, class WriteBlock>
+	void transform_stream_range(Matrix4 const& m, PositionStreams const& positions, Write write, WriteBlock writeBlock) {
+		const std::size_t count = positions.size();
+		const float* xs = positions.x.data();
+		const float* ys = positions.y.data();
+		const float* zs = positions.z.data();
+		std::size_t i = 0;
+#if defined(TETRAGON_SIMD_AVX2)
+		const auto row8 = [&m](const uint row) {
+			return std::array {
+				_mm256_set1_ps(m(row, 0)), _mm256_set1_ps(m(row, 1)),
+				_mm256_set1_ps(m(row, 2)), _mm256_set1_ps(m(row, 3))
+			};
+		};
+		const std::array rows8 { row8(0), row8(1), row8(2) };
+		for (; i + 8 <= count; i += 8) {
+			const __m256 x = _mm256_loadu_ps(xs + i);
+			const __m256 y = _mm256_loadu_ps(ys + i);
+			const __m256 z = _mm256_loadu_ps(zs + i);
+			__m256 out[3];
+			for (uint row = 0; row < 3; row++) {
+				auto const& r = rows8[row];
+				out[row] = multiply_add(r[0], x, multiply_add(r[1], y, multiply_add(r[2], z, r[3])));
+			}
+			writeBlock(i, out);
+		}
+#endif
+#if defined(TETRAGON_SIMD_SSE)
+		const auto row4 = [&m](const uint row) {
+			return std::array {
+				_mm_set1_ps(m(row, 0)), _mm_set1_ps(m(row, 1)),
+				_mm_set1_ps(m(row, 2)), _mm_set1_ps(m(row, 3))
+			};
+		};
+		const std::array rows4 { row4(0), row4(1), row4(2) };
+		for (; i + 4 <= count; i += 4) {
+			const __m128 x = _mm_loadu_ps(xs + i);
+			const __m128 y = _mm_loadu_ps(ys + i);
+			const __m128 z = _mm_loadu_ps(zs + i);
+			__m128 out[3];
+			for (uint row = 0; row < 3; row++) {
+				auto const& r = rows4[row];
+				out[row] = multiply_add(r[0], x, multiply_add(r[1], y, multiply_add(r[2], z, r[3])));
+			}
+			writeBlock(i, out);
+		}
+#endif
+		for (; i < count; i++) {
+			write(i,
+				m(0, 0) * xs[i] + m(0, 1) * ys[i] + m(0, 2) * zs[i] + m(0, 3),
+				m(1, 0) * xs[i] + m(1, 1) * ys[i] + m(1, 2) * zs[i] + m(1, 3),
+				m(2, 0) * xs[i] + m(2, 1) * ys[i] + m(2, 2) * zs[i] + m(2, 3));
+		}
+	}
+
+	template<class Register>
+	constexpr std::size_t lanes = sizeof(Register) / sizeof(float);
+}
+
+void transform_streams(Matrix4 const& matrix, const PositionStreams positions, const OutputStreams result) {
+	check_streams("transform_streams", positions);
+	check_sizes("transform_streams", positions.size(), result.x.size());
+	check_sizes("transform_streams", positions.size(), result.y.size());
+	check_sizes("transform_streams", positions.size(), result.z.size());
+	float* outputs[3] { result.x.data(), result.y.data(), result.z.data() };
+
+	transform_stream_range(matrix, positions,
+		[&](const std::size_t i, const float x, const float y, const float z) {
+			outputs[0][i] = x;
+			outputs[1][i] = y;
+			outputs[2][i] = z;
+		},
+		[&]<class Register>(const std::size_t i, const Register (&out)[3]) {
+			for (uint axis = 0; axis < 3; axis++) {
+				memcpy(outputs[axis] + i, &out[axis], sizeof(Register));
+			}
+		});
+}
+
+void transform_streams(Matrix4 const& matrix, const PositionStreams positions,
+		const std::span<std::byte> destination, const std::size_t stride, const std::size_t offset) {
+	check_streams("transform_streams", positions);
+	if (offset + 3 * sizeof(float) > stride || positions.size() * stride > destination.size()) {
+		spdlog::error("Cannot write {} positions at offset {} with stride {} into {} bytes",
+			positions.size(), offset, stride, destination.size());
+		throw std::invalid_argument("Destination cannot hold the transformed positions");
+	}
+	std::byte* base = destination.data() + offset;
+
+	const auto write = [&](const std::size_t i, const float x, const float y, const float z) {
+		const float position[3] { x, y, z };
+		memcpy(base + i * stride, position, sizeof(position));
+	};
+	transform_stream_range(matrix, positions, write,
+		[&]<class Register>(const std::size_t i, const Register (&out)[3]) {
+			float components[3][lanes<Register>];
+			for (uint axis = 0; axis < 3; axis++) {
+				memcpy(components[axis], &out[axis], sizeof(Register));
+			}
+			for (std::size_t lane = 0; lane < lanes<Register>; lane++) {
+				write(i + lane, components[0][lane], components[1][lane], components[2][lane]);
+			}
+		});
+}
+
+std::span<std::byte> transform_into(Matrix4 const& matrix, const PositionStreams positions,
+		VertexBuffer& buffer, const std::size_t offset) {
+	check_streams("transform_into", positions);
+	if (offset + 3 * sizeof(float) > buffer.vertex_size()) {
+		spdlog::error("Cannot write positions at offset {} into vertices of {} bytes", offset, buffer.vertex_size());
+		throw std::invalid_argument("Vertex cannot hold the transformed position");
+	}
+	const std::span<std::byte> staged = buffer.stage(positions.size());
+	transform_streams(matrix, positions, staged, buffer.vertex_size(), offset);
+	return staged;
+}
+
+} // tetragon::graphics::kernels
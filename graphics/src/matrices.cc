@@ -0,0 +1,252 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#include "matrices.hpp"
+#include "simd.hpp"
+
+namespace tetragon::graphics {
+
+Matrix3::Matrix3(const float diagonal) {
+	for (uint i = 0; i < SIZE; i++) {
+		(*this)(i, i) = diagonal;
+	}
+}
+
+Matrix3 Matrix3::identity() {
+	return Matrix3(1);
+}
+
+float& Matrix3::operator()(const uint row, const uint column) {
+	return values[column * SIZE + row];
+}
+
+float Matrix3::operator()(const uint row, const uint column) const {
+	return values[column * SIZE + row];
+}
+
+const float* Matrix3::data() const {
+	return values;
+}
+
+Matrix3 Matrix3::transposed() const {
+	Matrix3 result;
+	for (uint row = 0; row < SIZE; row++) {
+		for (uint column = 0; column < SIZE; column++) {
+			result(column, row) = (*this)(row, column);
+		}
+	}
+	return result;
+}
+
+bool Matrix3::operator==(Matrix3 const& other) const {
+	return std::equal(std::begin(values), std::end(values), std::begin(other.values));
+}
+
+Matrix4::Matrix4(const float diagonal) {
+	for (uint i = 0; i < SIZE; i++) {
+		(*this)(i, i) = diagonal;
+	}
+}
+
+Matrix4 Matrix4::identity() {
+	return Matrix4(1);
+}
+
+Matrix4 Matrix4::translation(const Vector3 offset) {
+	Matrix4 result(1);
+	result(0, 3) = offset.x;
+	result(1, 3) = offset.y;
+	result(2, 3) = offset.z;
+	return result;
+}
+
+Matrix4 Matrix4::scaling(const Vector3 factors) {
+	Matrix4 result;
+	result(0, 0) = factors.x;
+	result(1, 1) = factors.y;
+	result(2, 2) = factors.z;
+	result(3, 3) = 1;
+	return result;
+}
+
+Matrix4 Matrix4::look_at(const Vector3 eye, const Vector3 target, const Vector3 up) {
+	const Vector3 forward = normalized(target - eye);
+	const Vector3 side = normalized(cross(forward, up));
+	const Vector3 realUp = cross(side, forward);
+
+	Matrix4 result(1);
+	for (uint i = 0; i < 3; i++) {
+		result(0, i) = side[i];
+		result(1, i) = realUp[i];
+		result(2, i) = -forward[i];
+	}
+	result(0, 3) = -dot(side, eye);
+	result(1, 3) = -dot(realUp, eye);
+	result(2, 3) = dot(forward, eye);
+	return result;
+}
+
+Matrix4 Matrix4::perspective(const float fieldOfView, const float aspectRatio, const float near, const float far) {
+	const float focalLength = 1 / std::tan(fieldOfView / 2);
+	Matrix4 result;
+	result(0, 0) = focalLength / aspectRatio;
+	result(1, 1) = focalLength;
+	result(2, 2) = (far + near) / (near - far);
+	result(2, 3) = 2 * far * near / (near - far);
+	result(3, 2) = -1;
+	return result;
+}
+
+Matrix4 Matrix4::orthographic(const float left, const float right, const float bottom, const float top,
+		const float near, const float far) {
+	Matrix4 result(1);
+	result(0, 0) = 2 / (right - left);
+	result(1, 1) = 2 / (top - bottom);
+	result(2, 2) = -2 / (far - near);
+	result(0, 3) = -(right + left) / (right - left);
+	result(1, 3) = -(top + bottom) / (top - bottom);
+	result(2, 3) = -(far + near) / (far - near);
+	return result;
+}
+
+float& Matrix4::operator()(const uint row, const uint column) {
+	return values[column * SIZE + row];
+}
+
+float Matrix4::operator()(const uint row, const uint column) const {
+	return values[column * SIZE + row];
+}
+
+const float* Matrix4::data() const {
+	return values;
+}
+
+Vector4 Matrix4::column(const uint index) const {
+	const float* column = values + index * SIZE;
+	return { column[0], column[1], column[2], column[3] };
+}
+
+Matrix4 Matrix4::transposed() const {
+	Matrix4 result;
+	for (uint row = 0; row < SIZE; row++) {
+		for (uint column = 0; column < SIZE; column++) {
+			result(column, row) = (*this)(row, column);
+		}
+	}
+	return result;
+}
+
+namespace {
+	// Cofactors of the first column together with the 2x2 minors shared by
+	// the remaining ones, following the Laplace expansion used by MESA
+	struct Minors {
+		float s[6];
+		float c[6];
+	};
+
+	Minors compute_minors(Matrix4 const& m) {
+		return {
+			{
+				m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1),
+				m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2),
+				m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3),
+				m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2),
+				m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3),
+				m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3)
+			},
+			{
+				m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1),
+				m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2),
+				m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3),
+				m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2),
+				m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3),
+				m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3)
+			}
+		};
+	}
+
+	float determinant_of(Minors const& minors) {
+		auto const& [s, c] = minors;
+		return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+	}
+}
+
+float Matrix4::determinant() const {
+	return determinant_of(compute_minors(*this));
+}
+
+Matrix4 Matrix4::inverse() const {
+	const Minors minors = compute_minors(*this);
+	const float determinant = determinant_of(minors);
+	if (determinant == 0) {
+		spdlog::error("Cannot invert a singular matrix");
+		throw std::domain_error("Matrix is not invertible");
+	}
+	auto const& [s, c] = minors;
+	Matrix4 const& m = *this;
+	const float inverseDeterminant = 1 / determinant;
+
+	Matrix4 result;
+	result(0, 0) = ( m(1, 1) * c[5] - m(1, 2) * c[4] + m(1, 3) * c[3]) * inverseDeterminant;
+	result(0, 1) = (-m(0, 1) * c[5] + m(0, 2) * c[4] - m(0, 3) * c[3]) * inverseDeterminant;
+	result(0, 2) = ( m(3, 1) * s[5] - m(3, 2) * s[4] + m(3, 3) * s[3]) * inverseDeterminant;
+	result(0, 3) = (-m(2, 1) * s[5] + m(2, 2) * s[4] - m(2, 3) * s[3]) * inverseDeterminant;
+
+	result(1, 0) = (-m(1, 0) * c[5] + m(1, 2) * c[2] - m(1, 3) * c[1]) * inverseDeterminant;
+	result(1, 1) = ( m(0, 0) * c[5] - m(0, 2) * c[2] + m(0, 3) * c[1]) * inverseDeterminant;
+	result(1, 2) = (-m(3, 0) * s[5] + m(3, 2) * s[2] - m(3, 3) * s[1]) * inverseDeterminant;
+	result(1, 3) = ( m(2, 0) * s[5] - m(2, 2) * s[2] + m(2, 3) * s[1]) * inverseDeterminant;
+
+	result(2, 0) = ( m(1, 0) * c[4] - m(1, 1) * c[2] + m(1, 3) * c[0]) * inverseDeterminant;
+	result(2, 1) = (-m(0, 0) * c[4] + m(0, 1) * c[2] - m(0, 3) * c[0]) * inverseDeterminant;
+	result(2, 2) = ( m(3, 0) * s[4] - m(3, 1) * s[2] + m(3, 3) * s[0]) * inverseDeterminant;
+	result(2, 3) = (-m(2, 0) * s[4] + m(2, 1) * s[2] - m(2, 3) * s[0]) * inverseDeterminant;
+
+	result(3, 0) = (-m(1, 0) * c[3] + m(1, 1) * c[1] - m(1, 2) * c[0]) * inverseDeterminant;
+	result(3, 1) = ( m(0, 0) * c[3] - m(0, 1) * c[1] + m(0, 2) * c[0]) * inverseDeterminant;
+	result(3, 2) = (-m(3, 0) * s[3] + m(3, 1) * s[1] - m(3, 2) * s[0]) * inverseDeterminant;
+	result(3, 3) = ( m(2, 0) * s[3] - m(2, 1) * s[1] + m(2, 2) * s[0]) * inverseDeterminant;
+	return result;
+}
+
+Vector3 Matrix4::transform_point(const Vector3 point) const {
+	const Vector4 result = *this * Vector4 { point.x, point.y, point.z, 1 };
+	return { result.x, result.y, result.z };
+}
+
+Vector3 Matrix4::transform_direction(const Vector3 direction) const {
+	const Vector4 result = *this * Vector4 { direction.x, direction.y, direction.z, 0 };
+	return { result.x, result.y, result.z };
+}
+
+Vector4 Matrix4::operator*(Vector4 const& vector) const {
+#ifdef TETRAGON_SIMD_SSE
+	__m128 result = _mm_mul_ps(_mm_load_ps(values), _mm_set1_ps(vector.x));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(values + 4), _mm_set1_ps(vector.y)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(values + 8), _mm_set1_ps(vector.z)));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(values + 12), _mm_set1_ps(vector.w)));
+	Vector4 product;
+	_mm_store_ps(&product.x, result);
+	return product;
+#else
+	return column(0) * vector.x + column(1) * vector.y + column(2) * vector.z + column(3) * vector.w;
+#endif
+}
+
+Matrix4 Matrix4::operator*(Matrix4 const& other) const {
+	Matrix4 result;
+	for (uint i = 0; i < SIZE; i++) {
+		const Vector4 column = *this * other.column(i);
+		std::copy_n(&column.x, SIZE, result.values + i * SIZE);
+	}
+	return result;
+}
+
+bool Matrix4::operator==(Matrix4 const& other) const {
+	return std::equal(std::begin(values), std::end(values), std::begin(other.values));
+}
+
+} // tetragon::graphics
@@ -0,0 +1,319 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+
+#include "pool.hpp"
+#include "shaders.hpp"
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	std::size_t align_up(const std::size_t offset, const std::size_t alignment) {
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	GLObject create_buffer(const GLenum target, const std::size_t size, const GLenum usage) {
+		GLObject buffer;
+		glGenBuffers(1, &buffer);
+		GLStateCache::current().bind_buffer(target, buffer);
+		glBufferData(target, size, nullptr, usage);
+		return buffer;
+	}
+
+	void delete_buffer(const GLObject buffer) {
+		GLStateCache::current().forget_buffer(buffer);
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+GpuBufferPool::GpuBufferPool(const std::size_t pageSize, const VertexBuffer::Usage usage):
+		m_pageSize(pageSize),
+		m_usage(usage) {
+	if (pageSize < MIN_PAGE_SIZE || pageSize > MAX_PAGE_SIZE) {
+		spdlog::error("Failed to create a buffer pool with {} byte pages, as pages must have {} to {} bytes",
+			pageSize, MIN_PAGE_SIZE, MAX_PAGE_SIZE);
+		throw std::invalid_argument("Buffer pool page size out of range");
+	}
+}
+
+GpuBufferPool::~GpuBufferPool() {
+	for (Page const& page : m_pages) {
+		if (page.object != 0) delete_buffer(page.object);
+	}
+	if (m_scratch != 0) delete_buffer(m_scratch);
+}
+
+std::size_t GpuBufferPool::page_size() const {
+	return m_pageSize;
+}
+
+std::size_t GpuBufferPool::page_count() const {
+	return std::ranges::count_if(m_pages, [](Page const& page) { return page.object != 0; });
+}
+
+GLObject GpuBufferPool::page_object(const uint page) const {
+	if (page >= m_pages.size() || m_pages[page].object == 0) {
+		spdlog::error("Buffer pool has no page {}", page);
+		throw std::out_of_range("Buffer pool page out of range");
+	}
+	return m_pages[page].object;
+}
+
+GpuBufferPool::Handle GpuBufferPool::allocate(const std::size_t size, const std::size_t alignment) {
+	if (size == 0 || alignment == 0) {
+		spdlog::error("Failed to allocate {} bytes with alignment {} from buffer pool", size, alignment);
+		throw std::invalid_argument("Buffer pool allocation size and alignment must be positive");
+	}
+
+	uint pageIndex = 0;
+	std::size_t offset = 0;
+	for (; pageIndex < m_pages.size(); pageIndex++) {
+		Page& page = m_pages[pageIndex];
+		if (page.object != 0 && allocate_from(page, size, alignment, offset)) break;
+	}
+	if (pageIndex == m_pages.size()) {
+		pageIndex = create_page(std::max(m_pageSize, size));
+		allocate_from(m_pages[pageIndex], size, alignment, offset);
+	}
+
+	uint index;
+	if (m_freeSlots.empty()) {
+		index = m_slots.size();
+		m_slots.push_back({ {}, 0, 0, false });
+	} else {
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	Slot& slot = m_slots[index];
+	slot.range = { pageIndex, offset, size };
+	slot.alignment = alignment;
+	slot.live = true;
+	return { index, slot.generation };
+}
+
+void GpuBufferPool::free(const Handle handle) {
+	static_cast<void>(slot(handle));
+	Slot& freed = m_slots[handle.index];
+	release(m_pages[freed.range.page], freed.range.offset, freed.range.size);
+	freed.live = false;
+	freed.generation++;
+	m_freeSlots.push_back(handle.index);
+}
+
+bool GpuBufferPool::valid(const Handle handle) const {
+	return handle.index < m_slots.size() && m_slots[handle.index].live
+		&& m_slots[handle.index].generation == handle.generation;
+}
+
+GpuBufferPool::Range GpuBufferPool::range(const Handle handle) const {
+	return slot(handle).range;
+}
+
+int GpuBufferPool::base_vertex(const Handle handle, const std::size_t vertexSize) const {
+	const Range& range = slot(handle).range;
+	if (vertexSize == 0 || range.offset % vertexSize != 0) {
+		spdlog::error("Buffer pool allocation at offset {} is not aligned to vertex size {}",
+			range.offset, vertexSize);
+		throw std::invalid_argument("Buffer pool allocation is not vertex aligned");
+	}
+	return static_cast<int>(range.offset / vertexSize);
+}
+
+void GpuBufferPool::upload(const Handle handle, const void* data, const std::size_t size, const std::size_t offset) {
+	const Range& range = slot(handle).range;
+	if (offset + size > range.size) {
+		spdlog::error("Failed to upload {} bytes at offset {} into a buffer pool allocation of {} bytes",
+			size, offset, range.size);
+		throw std::out_of_range("Buffer pool upload out of range");
+	}
+	GLStateCache::current().bind_buffer(GL_COPY_WRITE_BUFFER, m_pages[range.page].object);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, range.offset + offset, size, data);
+}
+
+void GpuBufferPool::attach(const uint page, VertexAttribute const& attribute) const {
+	if (ShaderProgram::get_bound_instance() == nullptr) {
+		spdlog::error("Failed to attach attribute `{}`, as no shader program is bound", attribute.name());
+		std::terminate();
+	}
+	const uint location = ShaderProgram::get_bound_instance()->get_attribute_location(attribute);
+	if (location == static_cast<uint>(-1)) {
+		spdlog::warn("Skipping attribute `{}`, as the bound shader program does not use it", attribute.name());
+		return;
+	}
+
+	GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, page_object(page));
+	glVertexAttribPointer(location, attribute.size(), attribute.type(), attribute.normalized(),
+		attribute.stride(), reinterpret_cast<const void*>(static_cast<std::uintptr_t>(attribute.offset())));
+	glVertexAttribDivisor(location, attribute.divisor());
+	glEnableVertexAttribArray(location);
+}
+
+std::size_t GpuBufferPool::defragment() {
+	std::size_t moved = 0;
+	for (uint page = 0; page < m_pages.size(); page++) {
+		Page const& current = m_pages[page];
+		const bool fragmented = current.free.size() > 1
+			|| (current.free.size() == 1 && current.free[0].offset + current.free[0].size != current.capacity);
+		if (current.object != 0 && fragmented) {
+			moved += compact(page);
+		}
+	}
+	if (moved > 0) m_defragmentations++;
+	return moved;
+}
+
+void GpuBufferPool::release_empty_pages() {
+	for (Page& page : m_pages) {
+		if (page.object == 0 || page.allocations > 0) continue;
+		delete_buffer(page.object);
+		page = { 0, 0, 0, 0, {} };
+	}
+	if (m_scratch != 0) {
+		delete_buffer(m_scratch);
+		m_scratch = 0;
+		m_scratchSize = 0;
+	}
+}
+
+GpuBufferPool::Statistics GpuBufferPool::statistics() const {
+	Statistics statistics {};
+	for (Page const& page : m_pages) {
+		if (page.object == 0) continue;
+		statistics.pages++;
+		statistics.capacity += page.capacity;
+		statistics.used += page.used;
+		statistics.allocations += page.allocations;
+		statistics.freeBlocks += page.free.size();
+		for (Block const& block : page.free) {
+			statistics.free += block.size;
+			statistics.largestFree = std::max(statistics.largestFree, block.size);
+		}
+	}
+	statistics.defragmentations = m_defragmentations;
+	statistics.movedBytes = m_movedBytes;
+	return statistics;
+}
+
+uint GpuBufferPool::create_page(const std::size_t capacity) {
+	const GLObject object = create_buffer(GL_COPY_WRITE_BUFFER, capacity, static_cast<GLenum>(m_usage));
+	Page page { object, capacity, 0, 0, { { 0, capacity } } };
+	const auto empty = std::ranges::find(m_pages, GLObject(0), &Page::object);
+	if (empty != m_pages.end()) {
+		*empty = std::move(page);
+		return empty - m_pages.begin();
+	}
+	m_pages.push_back(std::move(page));
+	return m_pages.size() - 1;
+}
+
+bool GpuBufferPool::allocate_from(Page& page, const std::size_t size, const std::size_t alignment,
+		std::size_t& offset) {
+	for (auto block = page.free.begin(); block != page.free.end(); ++block) {
+		const std::size_t aligned = align_up(block->offset, alignment);
+		const std::size_t end = block->offset + block->size;
+		if (aligned + size > end) continue;
+
+		const std::size_t front = aligned - block->offset;
+		const std::size_t back = end - (aligned + size);
+		if (front > 0 && back > 0) {
+			block->size = front;
+			page.free.insert(block + 1, { aligned + size, back });
+		} else if (front > 0) {
+			block->size = front;
+		} else if (back > 0) {
+			*block = { aligned + size, back };
+		} else {
+			page.free.erase(block);
+		}
+		page.used += size;
+		page.allocations++;
+		offset = aligned;
+		return true;
+	}
+	return false;
+}
+
+void GpuBufferPool::release(Page& page, const std::size_t offset, const std::size_t size) {
+	auto next = std::ranges::lower_bound(page.free, offset, {}, &Block::offset);
+	auto block = page.free.insert(next, { offset, size });
+	if (block + 1 != page.free.end() && block->offset + block->size == (block + 1)->offset) {
+		block->size += (block + 1)->size;
+		page.free.erase(block + 1);
+	}
+	if (block != page.free.begin() && (block - 1)->offset + (block - 1)->size == block->offset) {
+		(block - 1)->size += block->size;
+		page.free.erase(block);
+	}
+	page.used -= size;
+	page.allocations--;
+}
+
+// Live data is copied to a scratch buffer first, as glCopyBufferSubData
+// must not be used with overlapping ranges of one buffer.
+std::size_t GpuBufferPool::compact(const uint pageIndex) {
+	Page& page = m_pages[pageIndex];
+	std::vector<Slot*> slots;
+	for (Slot& slot : m_slots) {
+		if (slot.live && slot.range.page == pageIndex) slots.push_back(&slot);
+	}
+	std::ranges::sort(slots, {}, [](const Slot* slot) { return slot->range.offset; });
+
+	std::vector<std::size_t> offsets;
+	offsets.reserve(slots.size());
+	std::size_t cursor = 0;
+	std::size_t first = slots.size();
+	for (std::size_t i = 0; i < slots.size(); i++) {
+		offsets.push_back(align_up(cursor, slots[i]->alignment));
+		cursor = offsets[i] + slots[i]->range.size;
+		if (first == slots.size() && offsets[i] != slots[i]->range.offset) first = i;
+	}
+	if (first == slots.size()) return 0;
+
+	const std::size_t begin = slots[first]->range.offset;
+	const std::size_t end = slots.back()->range.offset + slots.back()->range.size;
+	reserve_scratch(end - begin);
+
+	GLStateCache& state = GLStateCache::current();
+	state.bind_buffer(GL_COPY_READ_BUFFER, page.object);
+	state.bind_buffer(GL_COPY_WRITE_BUFFER, m_scratch);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, begin, 0, end - begin);
+	state.bind_buffer(GL_COPY_READ_BUFFER, m_scratch);
+	state.bind_buffer(GL_COPY_WRITE_BUFFER, page.object);
+
+	std::size_t moved = 0;
+	page.free.clear();
+	std::size_t previousEnd = 0;
+	for (std::size_t i = 0; i < slots.size(); i++) {
+		Range& range = slots[i]->range;
+		if (offsets[i] > previousEnd) page.free.push_back({ previousEnd, offsets[i] - previousEnd });
+		if (offsets[i] != range.offset) {
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.offset - begin, offsets[i], range.size);
+			range.offset = offsets[i];
+			m_movedBytes += range.size;
+			moved++;
+		}
+		previousEnd = range.offset + range.size;
+	}
+	if (previousEnd < page.capacity) page.free.push_back({ previousEnd, page.capacity - previousEnd });
+	return moved;
+}
+
+void GpuBufferPool::reserve_scratch(const std::size_t size) {
+	if (size <= m_scratchSize) return;
+	if (m_scratch != 0) delete_buffer(m_scratch);
+	m_scratch = create_buffer(GL_COPY_WRITE_BUFFER, size, GL_STREAM_COPY);
+	m_scratchSize = size;
+}
+
+GpuBufferPool::Slot const& GpuBufferPool::slot(const Handle handle) const {
+	if (!valid(handle)) {
+		spdlog::error("Buffer pool handle {} (generation {}) is not a live allocation", handle.index, handle.generation);
+		throw std::invalid_argument("Invalid buffer pool handle");
+	}
+	return m_slots[handle.index];
+}
+
+} // tetragon::graphics
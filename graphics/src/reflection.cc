@@ -0,0 +1,40 @@
+#include <bit>
+#include <utility>
+
+#include "reflection.hpp"
+
+namespace tetragon::graphics {
+
+ResourceTable::ResourceTable(std::vector<ProgramResource> resources):
+		m_resources(std::move(resources)),
+		m_slots(std::bit_ceil(m_resources.size() * 2 + 1), -1),
+		m_mask(m_slots.size() - 1) {
+	for (std::size_t i = 0; i < m_resources.size(); i++) {
+		std::size_t slot = m_resources[i].hash & m_mask;
+		while (m_slots[slot] != -1) {
+			slot = (slot + 1) & m_mask;
+		}
+		m_slots[slot] = static_cast<int>(i);
+	}
+}
+
+const ProgramResource* ResourceTable::find(const HashedName name) const {
+	if (m_slots.empty()) return nullptr;
+	for (std::size_t slot = name.hash & m_mask; m_slots[slot] != -1; slot = (slot + 1) & m_mask) {
+		ProgramResource const& resource = m_resources[m_slots[slot]];
+		if (resource.hash == name.hash && resource.name == name.name) {
+			return &resource;
+		}
+	}
+	return nullptr;
+}
+
+std::size_t ResourceTable::size() const {
+	return m_resources.size();
+}
+
+std::vector<ProgramResource> const& ResourceTable::resources() const {
+	return m_resources;
+}
+
+} // tetragon::graphics
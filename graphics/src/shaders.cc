@@ -1,11 +1,17 @@
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 #include <fmt/color.h>
+#include <algorithm>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "shaders.hpp"
 
+#include "binaries.hpp"
+#include "matrices.hpp"
 #include "primitives.hpp"
+#include "state.hpp"
 
 namespace tetragon::graphics {
 
@@ -18,10 +24,14 @@ namespace {
 		throw std::runtime_error("Unexpected shader type");
 	}
 
-	GLObject create_shader(const ShaderType type, const char* source) {
+	GLObject compile_shader(const ShaderType type, const char* source) {
 		const GLObject shader = glCreateShader(convert_shader_type(type));
 		glShaderSource(shader, 1, &source, nullptr);
 		glCompileShader(shader);
+		return shader;
+	}
+
+	void check_shader(const GLObject shader) {
 		int success;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (!success) {
@@ -30,8 +40,53 @@ namespace {
 			spdlog::error("Failed to build a shader: {}", message);
 			throw std::runtime_error(message);
 		}
+	}
+
+	void check_program(const GLObject program) {
+		int success;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			char message[512];
+			glGetProgramInfoLog(program, 512, nullptr, message);
+			spdlog::error("Failed to link a shader program: {}", message);
+			throw std::runtime_error(message);
+		}
+	}
+
+	GLObject create_shader(const ShaderType type, const char* source) {
+		const GLObject shader = compile_shader(type, source);
+		try {
+			check_shader(shader);
+		} catch (...) {
+			glDeleteShader(shader);
+			throw;
+		}
 		return shader;
 	}
+
+	// Defines go right after the `#version` directive, which has to stay the
+	// first statement; a `#line` directive keeps error line numbers intact.
+	std::string inject_defines(std::string const& source,
+			std::vector<std::pair<std::string, std::string>> const& defines) {
+		if (defines.empty()) return source;
+		std::size_t position = 0;
+		std::size_t line = 1;
+		const std::size_t version = source.find("#version");
+		if (version != std::string::npos) {
+			position = source.find('\n', version);
+			position = position == std::string::npos ? source.size() : position + 1;
+			line += std::count(source.begin(), source.begin() + position, '\n');
+		}
+
+		std::string injected;
+		for (auto const& [name, value] : defines) {
+			injected += fmt::format("#define {} {}\n", name, value);
+		}
+		injected += fmt::format("#line {}\n", line);
+		std::string result = source;
+		result.insert(position, injected);
+		return result;
+	}
 }
 
 Shader::Shader(const ShaderType type, const char* source):
@@ -42,79 +97,242 @@ Shader::~Shader() {
 	glDeleteShader(m_object);
 }
 
-// template<>
-// void Uniform<double>::set_value(double const& value) {
-// 	program().bind();
-// 	glUniform1d(location(), value);
-// }
-//
-// template<>
-// double Uniform<double>::value() const {
-// 	double value;
-// 	glGetUniformdv(program().m_object, location(), &value);
-// 	return value;
-// }
+namespace {
+	// Per-type glUniform*v and glGetUniform*v calls. Vectors and matrices
+	// are plain floats, so arrays of them upload with one call too.
+	template<class T>
+	struct uniform_io;
 
-template<>
-void Uniform<float>::set_value(float const& value) {
-	bind_program();
-	glUniform1f(location(), value);
-}
+	// template<>
+	// struct uniform_io<double> {
+	// 	static void upload(const int location, const GLsizei count, const double* values) {
+	// 		glUniform1dv(location, count, values);
+	// 	}
+	// 	static void fetch(const GLObject program, const int location, double* value) {
+	// 		glGetUniformdv(program, location, value);
+	// 	}
+	// };
 
-template<>
-float Uniform<float>::value() const {
-	float value;
-	glGetUniformfv(program().m_object, location(), &value);
-	return value;
-}
+	template<>
+	struct uniform_io<float> {
+		static void upload(const int location, const GLsizei count, const float* values) {
+			glUniform1fv(location, count, values);
+		}
+		static void fetch(const GLObject program, const int location, float* value) {
+			glGetUniformfv(program, location, value);
+		}
+	};
 
-template<>
-void Uniform<int>::set_value(int const& value) {
-	bind_program();
-	glUniform1i(location(), value);
-}
+	template<>
+	struct uniform_io<int> {
+		static void upload(const int location, const GLsizei count, const int* values) {
+			glUniform1iv(location, count, values);
+		}
+		static void fetch(const GLObject program, const int location, int* value) {
+			glGetUniformiv(program, location, value);
+		}
+	};
 
-template<>
-int Uniform<int>::value() const {
-	int value;
-	glGetUniformiv(program().m_object, location(), &value);
-	return value;
-}
+	template<>
+	struct uniform_io<uint> {
+		static void upload(const int location, const GLsizei count, const uint* values) {
+			glUniform1uiv(location, count, values);
+		}
+		static void fetch(const GLObject program, const int location, uint* value) {
+			glGetUniformuiv(program, location, value);
+		}
+	};
 
-template<>
-void Uniform<uint>::set_value(uint const& value) {
-	bind_program();
-	glUniform1ui(location(), value);
-}
+	template<class T, uint Components>
+	struct float_uniform_io {
+		static_assert(sizeof(T) == Components * sizeof(float), "Uniform type must be tightly packed floats");
+	};
 
-template<>
-uint Uniform<uint>::value() const {
-	uint value;
-	glGetUniformuiv(program().m_object, location(), &value);
-	return value;
+	template<>
+	struct uniform_io<Vector2> : float_uniform_io<Vector2, 2> {
+		static void upload(const int location, const GLsizei count, const Vector2* values) {
+			glUniform2fv(location, count, &values->x);
+		}
+	};
+
+	template<>
+	struct uniform_io<Vector3> : float_uniform_io<Vector3, 3> {
+		static void upload(const int location, const GLsizei count, const Vector3* values) {
+			glUniform3fv(location, count, &values->x);
+		}
+	};
+
+	template<>
+	struct uniform_io<Vector4> : float_uniform_io<Vector4, 4> {
+		static void upload(const int location, const GLsizei count, const Vector4* values) {
+			glUniform4fv(location, count, &values->x);
+		}
+	};
+
+	template<>
+	struct uniform_io<Matrix3> : float_uniform_io<Matrix3, 9> {
+		static void upload(const int location, const GLsizei count, const Matrix3* values) {
+			glUniformMatrix3fv(location, count, GL_FALSE, values->data());
+		}
+	};
+
+	template<>
+	struct uniform_io<Matrix4> : float_uniform_io<Matrix4, 16> {
+		static void upload(const int location, const GLsizei count, const Matrix4* values) {
+			glUniformMatrix4fv(location, count, GL_FALSE, values->data());
+		}
+	};
+
+	// Number of 32-bit components of the uniform types Uniform accepts, or
+	// zero for types without a shadow copy
+	uint uniform_components(const GLenum type) {
+		switch (type) {
+			case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+				return 1;
+			case GL_FLOAT_VEC2: return 2;
+			case GL_FLOAT_VEC3: return 3;
+			case GL_FLOAT_VEC4: return 4;
+			case GL_FLOAT_MAT3: return 9;
+			case GL_FLOAT_MAT4: return 16;
+			default:
+				return is_sampler_type(type) ? 1 : 0;
+		}
+	}
+
+	// Reads every uniform once after linking, so the shadow copies start out
+	// with the values of GLSL initialisers (or zero) and reading a value
+	// never has to query the driver
+	std::vector<std::vector<std::byte>> initial_uniform_values(const GLObject program, ResourceTable const& uniforms) {
+		std::vector<std::vector<std::byte>> values;
+		for (ProgramResource const& uniform : uniforms.resources()) {
+			const uint components = uniform_components(uniform.type);
+			if (components == 0) continue;
+			if (uniform.location >= static_cast<int>(values.size())) {
+				values.resize(uniform.location + 1);
+			}
+			const std::size_t elementSize = components * sizeof(float);
+			std::vector<std::byte>& value = values[uniform.location];
+			value.resize(elementSize * uniform.size);
+			for (int i = 0; i < uniform.size; i++) {
+				const int location = uniform.elements[i];
+				if (location < 0) continue;
+				std::byte* element = value.data() + i * elementSize;
+				switch (uniform.type) {
+					case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+					case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+						uniform_io<float>::fetch(program, location, reinterpret_cast<float*>(element));
+						break;
+					case GL_UNSIGNED_INT:
+						uniform_io<uint>::fetch(program, location, reinterpret_cast<uint*>(element));
+						break;
+					default:
+						uniform_io<int>::fetch(program, location, reinterpret_cast<int*>(element));
+						break;
+				}
+			}
+		}
+		return values;
+	}
 }
 
-template<>
-void Uniform<Vector3>::set_value(Vector3 const& value) {
-	bind_program();
-	glUniform3f(location(), value.x, value.y, value.z);
+template<IsUniformable T>
+void Uniform<T>::upload(T const& value) const {
+	uniform_io<T>::upload(location(), 1, &value);
 }
 
-template<>
-Vector3 Uniform<Vector3>::value() const {
-	float x, y, z;
-	glGetUniformfv(program().m_object, location(), &x);
-	return vec( x, y, z );
+template<IsUniformable T>
+void UniformArray<T>::upload(const std::span<const T> values, const std::size_t first) const {
+	const int location = m_elements[first];
+	if (location < 0) return;
+	uniform_io<T>::upload(location, static_cast<GLsizei>(values.size()), values.data());
 }
 
+template void Uniform<float>::upload(float const&) const;
+template void Uniform<int>::upload(int const&) const;
+template void Uniform<uint>::upload(uint const&) const;
+template void Uniform<Vector2>::upload(Vector2 const&) const;
+template void Uniform<Vector3>::upload(Vector3 const&) const;
+template void Uniform<Vector4>::upload(Vector4 const&) const;
+template void Uniform<Matrix3>::upload(Matrix3 const&) const;
+template void Uniform<Matrix4>::upload(Matrix4 const&) const;
+
+template void UniformArray<float>::upload(std::span<const float>, std::size_t) const;
+template void UniformArray<int>::upload(std::span<const int>, std::size_t) const;
+template void UniformArray<uint>::upload(std::span<const uint>, std::size_t) const;
+template void UniformArray<Vector2>::upload(std::span<const Vector2>, std::size_t) const;
+template void UniformArray<Vector3>::upload(std::span<const Vector3>, std::size_t) const;
+template void UniformArray<Vector4>::upload(std::span<const Vector4>, std::size_t) const;
+template void UniformArray<Matrix3>::upload(std::span<const Matrix3>, std::size_t) const;
+template void UniformArray<Matrix4>::upload(std::span<const Matrix4>, std::size_t) const;
+
 ShaderType Shader::get_type() const {
 	return m_type;
 }
 
-ShaderProgram::ShaderProgram(GLuint program): m_object(program) {
+namespace {
+	std::vector<ProgramResource> reflect_uniforms(const GLObject program) {
+		GLint count, maxLength;
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+		std::vector<ProgramResource> uniforms;
+		std::string name(maxLength, '\0');
+		for (GLint i = 0; i < count; i++) {
+			GLsizei length;
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(program, i, maxLength, &length, &size, &type, name.data());
+			std::string uniformName(name.data(), length);
+			if (uniformName.ends_with("[0]")) {
+				uniformName.resize(uniformName.size() - 3);
+			}
+			const int location = glGetUniformLocation(program, uniformName.c_str());
+			if (location < 0) continue;
+			// Locations of array elements other than the first are not
+			// guaranteed to follow it, so each is looked up by name once
+			std::vector<int> elements { location };
+			for (GLint element = 1; element < size; element++) {
+				elements.push_back(glGetUniformLocation(program, fmt::format("{}[{}]", uniformName, element).c_str()));
+			}
+			const std::uint64_t hash = hash_name(uniformName);
+			uniforms.push_back({ std::move(uniformName), hash, location, type, size, std::move(elements) });
+		}
+		return uniforms;
+	}
+
+	std::vector<ProgramResource> reflect_attributes(const GLObject program) {
+		GLint count, maxLength;
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+		std::vector<ProgramResource> attributes;
+		std::string name(maxLength, '\0');
+		for (GLint i = 0; i < count; i++) {
+			GLsizei length;
+			GLint size;
+			GLenum type;
+			glGetActiveAttrib(program, i, maxLength, &length, &size, &type, name.data());
+			std::string attributeName(name.data(), length);
+			const int location = glGetAttribLocation(program, attributeName.c_str());
+			if (location < 0) continue;
+			const std::uint64_t hash = hash_name(attributeName);
+			attributes.push_back({ std::move(attributeName), hash, location, type, size, {} });
+		}
+		return attributes;
+	}
+}
+
+ShaderProgram::ShaderProgram(GLuint program):
+		m_object(program),
+		m_uniforms(reflect_uniforms(program)),
+		m_attributes(reflect_attributes(program)),
+		m_uniformValues(initial_uniform_values(program, m_uniforms)) {
+	spdlog::debug("Reflected shader program {}: {} uniforms, {} attributes",
+		m_object, m_uniforms.size(), m_attributes.size());
 }
 
 ShaderProgram::~ShaderProgram() {
+	GLStateCache::current().forget_program(m_object);
 	glDeleteProgram(m_object);
 	if (is_bound()) {
 		boundInstance = nullptr;
@@ -128,7 +346,7 @@ ShaderProgram* ShaderProgram::get_bound_instance() {
 }
 
 void ShaderProgram::bind() {
-	glUseProgram(m_object);
+	GLStateCache::current().use_program(m_object);
 	boundInstance = this;
 }
 
@@ -137,11 +355,47 @@ bool ShaderProgram::is_bound() const {
 }
 
 GLuint ShaderProgram::get_attribute_location(VertexAttribute const& attribute) const {
-	return glGetAttribLocation(m_object, attribute.name());
+	const ProgramResource* resource = m_attributes.find(HashedName(attribute.name()));
+	return resource != nullptr ? resource->location : -1;
 }
 
-bool ShaderProgram::has_uniform(const char* name) const {
-	return glGetUniformLocation(m_object, name) != -1;
+ResourceTable const& ShaderProgram::uniforms() const {
+	return m_uniforms;
+}
+
+ResourceTable const& ShaderProgram::attributes() const {
+	return m_attributes;
+}
+
+bool ShaderProgram::store_uniform(const int location, const void* value, const std::size_t size) {
+	if (location >= static_cast<int>(m_uniformValues.size())) {
+		m_uniformValues.resize(location + 1);
+	}
+	std::vector<std::byte>& stored = m_uniformValues[location];
+	const auto* bytes = static_cast<const std::byte*>(value);
+	// A single value set on an array's location is its first element, so
+	// it merges into the shadow copy of the whole array
+	if (stored.size() >= size) {
+		if (memcmp(stored.data(), value, size) == 0) return false;
+		memcpy(stored.data(), bytes, size);
+		return true;
+	}
+	stored.assign(bytes, bytes + size);
+	return true;
+}
+
+const std::byte* ShaderProgram::stored_uniform(const int location, const std::size_t size) const {
+	if (location >= static_cast<int>(m_uniformValues.size())) return nullptr;
+	std::vector<std::byte> const& stored = m_uniformValues[location];
+	return stored.size() >= size ? stored.data() : nullptr;
+}
+
+std::byte* ShaderProgram::stored_uniform(const int location, const std::size_t size) {
+	return const_cast<std::byte*>(std::as_const(*this).stored_uniform(location, size));
+}
+
+bool ShaderProgram::has_uniform(const HashedName name) const {
+	return m_uniforms.find(name) != nullptr;
 }
 
 ShaderProgram::Builder::Builder() {
@@ -150,22 +404,156 @@ ShaderProgram::Builder::Builder() {
 
 ShaderProgram::Builder& ShaderProgram::Builder::attach_shader(Shader const& shader) {
 	glAttachShader(m_object, shader.m_object);
+	m_precompiled = true;
 	return *this;
 }
 
-ShaderProgram ShaderProgram::Builder::build() const {
+ShaderProgram::Builder& ShaderProgram::Builder::attach_source(const ShaderType type, std::string source) {
+	m_sources.push_back({ type, std::move(source) });
+	return *this;
+}
+
+ShaderProgram::Builder& ShaderProgram::Builder::add_define(std::string name, std::string value) {
+	m_defines.emplace_back(std::move(name), std::move(value));
+	return *this;
+}
+
+std::uint64_t ShaderProgram::Builder::sources_hash() const {
+	std::uint64_t hash = hash_name("");
+	for (ShaderSource const& source : m_sources) {
+		hash = combine_hash(hash, static_cast<std::uint64_t>(source.type));
+		hash = combine_hash(hash, hash_name(source.source));
+	}
+	for (auto const& [name, value] : m_defines) {
+		hash = combine_hash(hash, hash_name(name));
+		hash = combine_hash(hash, hash_name(value));
+	}
+	return hash;
+}
+
+std::vector<GLObject> ShaderProgram::Builder::compile_and_link() const {
+	std::vector<GLObject> shaders;
+	shaders.reserve(m_sources.size());
+	for (ShaderSource const& source : m_sources) {
+		const std::string code = inject_defines(source.source, m_defines);
+		shaders.push_back(compile_shader(source.type, code.c_str()));
+		glAttachShader(m_object, shaders.back());
+	}
 	glLinkProgram(m_object);
+	return shaders;
+}
+
+ShaderProgram ShaderProgram::Builder::build() const {
+	return build_async().get();
+}
+
+ShaderProgram ShaderProgram::Builder::build(ProgramBinaryCache& cache) const {
+	return build_async(cache).get();
+}
+
+PendingProgram ShaderProgram::Builder::build_async() const {
+	return PendingProgram(m_object, compile_and_link());
+}
+
+PendingProgram ShaderProgram::Builder::build_async(ProgramBinaryCache& cache) const {
+	if (m_precompiled || !cache.enabled()) {
+		return build_async();
+	}
+
+	const std::uint64_t key = cache.key(sources_hash());
+	if (cache.load(key, m_object)) {
+		return PendingProgram(m_object, {});
+	}
+
+	glProgramParameteri(m_object, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	return PendingProgram(m_object, compile_and_link(), &cache, key);
+}
+
+PendingProgram::PendingProgram(const GLObject program, std::vector<GLObject> shaders,
+		ProgramBinaryCache* cache, const std::uint64_t key):
+		m_object(program),
+		m_shaders(std::move(shaders)),
+		m_cache(cache),
+		m_key(key) {
+}
+
+PendingProgram::PendingProgram(PendingProgram&& other) noexcept:
+		m_object(other.m_object),
+		m_shaders(std::move(other.m_shaders)),
+		m_cache(other.m_cache),
+		m_key(other.m_key),
+		m_taken(other.m_taken) {
+	other.m_shaders.clear();
+	other.m_taken = true;
+}
+
+PendingProgram::~PendingProgram() {
+	for (const GLObject shader : m_shaders) {
+		glDetachShader(m_object, shader);
+		glDeleteShader(shader);
+	}
+	if (!m_taken) {
+		glDeleteProgram(m_object);
+	}
+}
+
+bool PendingProgram::is_parallel_supported() {
+	return GLAD_GL_KHR_parallel_shader_compile;
+}
+
+void PendingProgram::set_max_compiler_threads(const uint count) {
+	if (!is_parallel_supported()) return;
+	glMaxShaderCompilerThreadsKHR(count);
+}
+
+bool PendingProgram::is_ready() const {
+	if (m_taken || !is_parallel_supported()) return true;
+	int completed;
+	glGetProgramiv(m_object, GL_COMPLETION_STATUS_KHR, &completed);
+	return completed;
+}
+
+bool PendingProgram::is_taken() const {
+	return m_taken;
+}
+
+void PendingProgram::wait() const {
+	if (m_taken) return;
+	// Any status query blocks until the driver has finished the program
 	int success;
 	glGetProgramiv(m_object, GL_LINK_STATUS, &success);
-	if (!success) {
-		char message[512];
-		glGetProgramInfoLog(m_object, 512, nullptr, message);
-		spdlog::error("Failed to link a shader program: {}", message);
-		throw std::runtime_error(message);
-	}
-	return ShaderProgram(m_object);
 }
 
+ShaderProgram PendingProgram::get() {
+	if (m_taken) {
+		spdlog::error("Shader program {} was already taken from its pending handle", m_object);
+		throw std::logic_error("Pending program was already taken");
+	}
 
+	std::vector<GLObject> shaders = std::move(m_shaders);
+	m_shaders.clear();
+	const auto release_shaders = [&] {
+		for (const GLObject shader : shaders) {
+			glDetachShader(m_object, shader);
+			glDeleteShader(shader);
+		}
+	};
+	try {
+		for (const GLObject shader : shaders) {
+			check_shader(shader);
+		}
+		check_program(m_object);
+	} catch (...) {
+		release_shaders();
+		throw;
+	}
+	release_shaders();
+
+	if (m_cache != nullptr) {
+		m_cache->store(m_key, m_object);
+	}
+	m_taken = true;
+	return ShaderProgram(m_object);
+}
 
 } // tetragon::graphics
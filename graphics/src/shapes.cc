@@ -1,42 +1,54 @@
 #include <algorithm>
+#include <numeric>
 #include <utility>
 
 #include "shapes.hpp"
 
 namespace tetragon::graphics {
 
+    void Shape::buffer_to(VertexBuffer& buffer, ElementBuffer& elements) const {
+        const ElementBuffer::Index baseVertex = buffer.vertex_count();
+        buffer_to(buffer);
+        std::vector<ElementBuffer::Index> indices(buffer.vertex_count() - baseVertex);
+        std::iota(indices.begin(), indices.end(), baseVertex);
+        elements.buffer(indices);
+    }
+
     Triangle::Triangle(Vector3 a, Vector3 b, Vector3 c):
             a(std::move(a)), b(std::move(b)), c(std::move(c)) {
     }
 
     void Triangle::buffer_to(VertexBuffer& buffer) const {
-        buffer.buffer(a);
-        buffer.buffer(b);
-        buffer.buffer(c);
+        const Vector3 vertices[] { a, b, c };
+        buffer.buffer(std::span<const Vector3>(vertices));
+    }
+
+    /*
+        3	2
+
+        1	4
+    */
+    Square::Square(const Vector3 firstCorner, const Vector3 secondCorner) {
+        auto [minX, maxX] = std::minmax(firstCorner.x, secondCorner.x);
+        auto [minY, maxY] = std::minmax(firstCorner.y, secondCorner.y);
+        min = { minX, minY, firstCorner.z };
+        max = { maxX, maxY, firstCorner.z };
+    }
+
+    void Square::buffer_to(VertexBuffer& buffer) const {
+        const Vector3 vertices[] {
+            min, { min.x, max.y, min.z }, { max.x, min.y, min.z },
+            max, { max.x, min.y, min.z }, { min.x, max.y, min.z }
+        };
+        buffer.buffer(std::span<const Vector3>(vertices));
     }
 
-    //     /*
-//         3	2
-//
-//         1	4
-//     */
-//     Square::Square(Vertex firstCorner, Vertex secondCorner) {
-//         auto [maxX, minX] = std::minmax(firstCorner.x, secondCorner.x);
-//         auto [maxY, minY] = std::minmax(firstCorner.y, secondCorner.y);
-//         firstCorner = { minX, minY };
-//         secondCorner = { maxX, maxY };
-//         const Vertex thirdCorner{ minX, maxY };
-//         const Vertex fourthCorner{ maxX, minY };
-//         a = Triangle(firstCorner, thirdCorner, fourthCorner);
-//         b = Triangle(secondCorner, fourthCorner, thirdCorner);
-//     }
-//
-//     const Vertex* Square::vertecies() const {
-//         return a.vertecies();
-//     }
-//
-//     unsigned int Square::vertex_count() const {
-//         return a.vertex_count() + b.vertex_count();
-//     }
+    void Square::buffer_to(VertexBuffer& buffer, ElementBuffer& elements) const {
+        static constexpr ElementBuffer::Index indices[] { 0, 2, 3, 1, 3, 2 };
+        const Vector3 vertices[] { min, max, { min.x, max.y, min.z }, { max.x, min.y, min.z } };
+        const ElementBuffer::Index baseVertex = buffer.vertex_count();
+        buffer.buffer(std::span<const Vector3>(vertices));
+        elements.buffer(indices, baseVertex);
+    }
 
 } // tetragon::graphics
@@ -0,0 +1,161 @@
+#include <GLFW/glfw3.h>
+#include <spdlog/spdlog.h>
+
+#include "state.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	constexpr GLObject UNKNOWN = ~GLObject(0);
+}
+
+GLStateCache& GLStateCache::current() {
+	thread_local GLFWwindow* context = nullptr;
+	thread_local GLStateCache* cache = nullptr;
+	thread_local std::unordered_map<GLFWwindow*, GLStateCache> caches;
+
+	GLFWwindow* currentContext = glfwGetCurrentContext();
+	if (cache == nullptr || context != currentContext) {
+		context = currentContext;
+		cache = &caches[currentContext];
+	}
+	return *cache;
+}
+
+bool GLStateCache::skip(const bool redundant) {
+	if (redundant) {
+		m_avoided++;
+	} else {
+		m_issued++;
+	}
+	return redundant;
+}
+
+void GLStateCache::use_program(const GLObject program) {
+	if (skip(m_program == program)) return;
+	glUseProgram(program);
+	m_program = program;
+}
+
+void GLStateCache::bind_vertex_array(const GLObject vertexArray) {
+	if (skip(m_vertexArray == vertexArray)) return;
+	glBindVertexArray(vertexArray);
+	m_vertexArray = vertexArray;
+}
+
+GLStateCache::BufferBinding* GLStateCache::find_binding(const GLenum target) {
+	for (BufferBinding& binding : m_buffers) {
+		if (binding.target == target) return &binding;
+	}
+	return nullptr;
+}
+
+void GLStateCache::bind_buffer(const GLenum target, const GLObject buffer) {
+	if (target == GL_ELEMENT_ARRAY_BUFFER && m_vertexArray != UNKNOWN) {
+		auto [binding, inserted] = m_elementBuffers.try_emplace(m_vertexArray, UNKNOWN);
+		if (skip(binding->second == buffer)) return;
+		glBindBuffer(target, buffer);
+		binding->second = buffer;
+		return;
+	}
+	BufferBinding* binding = find_binding(target);
+	if (skip(binding != nullptr && binding->buffer == buffer)) return;
+	glBindBuffer(target, buffer);
+	if (binding != nullptr) {
+		binding->buffer = buffer;
+	}
+}
+
+void GLStateCache::bind_buffer_base(const GLenum target, const uint index, const GLObject buffer) {
+	if (target == GL_UNIFORM_BUFFER) {
+		if (index >= m_uniformBuffers.size()) {
+			m_uniformBuffers.resize(index + 1, UNKNOWN);
+		}
+		if (skip(m_uniformBuffers[index] == buffer)) return;
+		m_uniformBuffers[index] = buffer;
+	} else {
+		m_issued++;
+	}
+	glBindBufferBase(target, index, buffer);
+	if (BufferBinding* binding = find_binding(target)) {
+		binding->buffer = buffer;
+	}
+}
+
+void GLStateCache::set_viewport(const int x, const int y, const int width, const int height) {
+	const std::array viewport { x, y, width, height };
+	if (skip(m_viewportKnown && m_viewport == viewport)) return;
+	glViewport(x, y, width, height);
+	m_viewport = viewport;
+	m_viewportKnown = true;
+}
+
+GLObject GLStateCache::program() const {
+	return m_program;
+}
+
+GLObject GLStateCache::vertex_array() const {
+	return m_vertexArray;
+}
+
+GLObject GLStateCache::buffer(const GLenum target) const {
+	if (target == GL_ELEMENT_ARRAY_BUFFER) {
+		const auto binding = m_elementBuffers.find(m_vertexArray);
+		return binding != m_elementBuffers.end() ? binding->second : 0;
+	}
+	for (BufferBinding const& binding : m_buffers) {
+		if (binding.target == target) return binding.buffer;
+	}
+	return 0;
+}
+
+void GLStateCache::forget_program(const GLObject program) {
+	if (m_program == program) {
+		m_program = UNKNOWN;
+	}
+}
+
+void GLStateCache::forget_vertex_array(const GLObject vertexArray) {
+	m_elementBuffers.erase(vertexArray);
+	if (m_vertexArray == vertexArray) {
+		m_vertexArray = 0;
+	}
+}
+
+void GLStateCache::forget_buffer(const GLObject buffer) {
+	for (BufferBinding& binding : m_buffers) {
+		if (binding.buffer == buffer) binding.buffer = 0;
+	}
+	for (auto& [vertexArray, elementBuffer] : m_elementBuffers) {
+		if (elementBuffer == buffer) elementBuffer = UNKNOWN;
+	}
+	for (GLObject& uniformBuffer : m_uniformBuffers) {
+		if (uniformBuffer == buffer) uniformBuffer = UNKNOWN;
+	}
+}
+
+void GLStateCache::invalidate() {
+	m_program = UNKNOWN;
+	m_vertexArray = UNKNOWN;
+	for (BufferBinding& binding : m_buffers) {
+		binding.buffer = UNKNOWN;
+	}
+	m_elementBuffers.clear();
+	m_uniformBuffers.clear();
+	m_viewportKnown = false;
+}
+
+std::uint64_t GLStateCache::issued_calls() const {
+	return m_issued;
+}
+
+std::uint64_t GLStateCache::avoided_calls() const {
+	return m_avoided;
+}
+
+void GLStateCache::reset_statistics() {
+	m_issued = 0;
+	m_avoided = 0;
+}
+
+} // tetragon::graphics
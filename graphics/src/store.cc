@@ -0,0 +1,176 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+
+#include "store.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	constexpr std::size_t SQUARE_VERTICES = 6;
+	constexpr std::size_t INDEXED_SQUARE_VERTICES = 4;
+	constexpr ElementBuffer::Index SQUARE_INDICES[] { 0, 2, 3, 1, 3, 2 };
+
+	void check_index(const char* type, const std::size_t index, const std::size_t count) {
+		if (index >= count) {
+			spdlog::error("Failed to set {} #{} of shape store, as it holds only {}", type, index, count);
+			throw std::out_of_range("Shape store index out of range");
+		}
+	}
+
+	void check_vertex_size(VertexBuffer const& buffer) {
+		if (buffer.vertex_size() != sizeof(Vector3)) {
+			spdlog::error("Failed to upload shape store into a buffer with vertex size {}, as shapes are stored as Vector3",
+				buffer.vertex_size());
+			throw std::invalid_argument("Shape store needs a Vector3 vertex buffer");
+		}
+	}
+}
+
+std::size_t ShapeStore::add(Triangle const& triangle) {
+	m_triangles.insert(m_triangles.end(), { triangle.a, triangle.b, triangle.c });
+	return triangle_count() - 1;
+}
+
+std::size_t ShapeStore::add(Square const& square) {
+	m_squares.minX.push_back(square.min.x);
+	m_squares.minY.push_back(square.min.y);
+	m_squares.maxX.push_back(square.max.x);
+	m_squares.maxY.push_back(square.max.y);
+	m_squares.minZ.push_back(square.min.z);
+	m_squares.maxZ.push_back(square.max.z);
+	return square_count() - 1;
+}
+
+void ShapeStore::add(const std::span<const Triangle> triangles) {
+	m_triangles.reserve(m_triangles.size() + triangles.size() * 3);
+	for (Triangle const& triangle : triangles) {
+		add(triangle);
+	}
+}
+
+void ShapeStore::add(const std::span<const Square> squares) {
+	reserve(triangle_count(), square_count() + squares.size());
+	for (Square const& square : squares) {
+		add(square);
+	}
+}
+
+void ShapeStore::set(const std::size_t index, Triangle const& triangle) {
+	check_index("triangle", index, triangle_count());
+	m_triangles[index * 3] = triangle.a;
+	m_triangles[index * 3 + 1] = triangle.b;
+	m_triangles[index * 3 + 2] = triangle.c;
+}
+
+void ShapeStore::set(const std::size_t index, Square const& square) {
+	check_index("square", index, square_count());
+	m_squares.minX[index] = square.min.x;
+	m_squares.minY[index] = square.min.y;
+	m_squares.maxX[index] = square.max.x;
+	m_squares.maxY[index] = square.max.y;
+	m_squares.minZ[index] = square.min.z;
+	m_squares.maxZ[index] = square.max.z;
+}
+
+std::size_t ShapeStore::triangle_count() const {
+	return m_triangles.size() / 3;
+}
+
+std::size_t ShapeStore::square_count() const {
+	return m_squares.minZ.size();
+}
+
+std::size_t ShapeStore::vertex_count() const {
+	return m_triangles.size() + square_count() * SQUARE_VERTICES;
+}
+
+std::size_t ShapeStore::indexed_vertex_count() const {
+	return m_triangles.size() + square_count() * INDEXED_SQUARE_VERTICES;
+}
+
+std::size_t ShapeStore::index_count() const {
+	return m_triangles.size() + square_count() * std::size(SQUARE_INDICES);
+}
+
+bool ShapeStore::empty() const {
+	return m_triangles.empty() && m_squares.minZ.empty();
+}
+
+void ShapeStore::reserve(const std::size_t triangleCount, const std::size_t squareCount) {
+	m_triangles.reserve(triangleCount * 3);
+	for (std::vector<float>* values : { &m_squares.minX, &m_squares.minY, &m_squares.maxX, &m_squares.maxY,
+			&m_squares.minZ, &m_squares.maxZ }) {
+		values->reserve(squareCount);
+	}
+}
+
+void ShapeStore::clear() {
+	m_triangles.clear();
+	for (std::vector<float>* values : { &m_squares.minX, &m_squares.minY, &m_squares.maxX, &m_squares.maxY,
+			&m_squares.minZ, &m_squares.maxZ }) {
+		values->clear();
+	}
+}
+
+/*
+	Vertex order matches Square::buffer_to,
+	min, (minX, maxY), (maxX, minY), max, (maxX, minY), (minX, maxY)
+*/
+void ShapeStore::upload(VertexBuffer& buffer) const {
+	check_vertex_size(buffer);
+	if (empty()) return;
+	const std::span<std::byte> staged = buffer.stage(vertex_count());
+	const std::size_t triangleBytes = m_triangles.size() * sizeof(Vector3);
+	memcpy(staged.data(), m_triangles.data(), triangleBytes);
+
+	std::byte* out = staged.data() + triangleBytes;
+	const Squares& squares = m_squares;
+	for (std::size_t i = 0; i < square_count(); i++) {
+		const float minX = squares.minX[i], minY = squares.minY[i];
+		const float maxX = squares.maxX[i], maxY = squares.maxY[i];
+		const float minZ = squares.minZ[i], maxZ = squares.maxZ[i];
+		const float vertices[SQUARE_VERTICES * 3] {
+			minX, minY, minZ,  minX, maxY, minZ,  maxX, minY, minZ,
+			maxX, maxY, maxZ,  maxX, minY, minZ,  minX, maxY, minZ
+		};
+		memcpy(out, vertices, sizeof(vertices));
+		out += sizeof(vertices);
+	}
+}
+
+void ShapeStore::upload(VertexBuffer& buffer, ElementBuffer& elements) const {
+	check_vertex_size(buffer);
+	if (empty()) return;
+	const auto baseVertex = static_cast<ElementBuffer::Index>(buffer.vertex_count());
+	const std::span<std::byte> staged = buffer.stage(indexed_vertex_count());
+	const std::size_t triangleBytes = m_triangles.size() * sizeof(Vector3);
+	memcpy(staged.data(), m_triangles.data(), triangleBytes);
+
+	std::vector<ElementBuffer::Index> indices(index_count());
+	std::iota(indices.begin(), indices.begin() + m_triangles.size(), ElementBuffer::Index(0));
+
+	std::byte* out = staged.data() + triangleBytes;
+	auto index = indices.begin() + m_triangles.size();
+	auto first = static_cast<ElementBuffer::Index>(m_triangles.size());
+	const Squares& squares = m_squares;
+	for (std::size_t i = 0; i < square_count(); i++) {
+		const float minX = squares.minX[i], minY = squares.minY[i];
+		const float maxX = squares.maxX[i], maxY = squares.maxY[i];
+		const float minZ = squares.minZ[i], maxZ = squares.maxZ[i];
+		const float vertices[INDEXED_SQUARE_VERTICES * 3] {
+			minX, minY, minZ,  maxX, maxY, maxZ,  minX, maxY, minZ,  maxX, minY, minZ
+		};
+		memcpy(out, vertices, sizeof(vertices));
+		out += sizeof(vertices);
+		index = std::transform(std::begin(SQUARE_INDICES), std::end(SQUARE_INDICES), index,
+			[first](const ElementBuffer::Index value) { return first + value; });
+		first += INDEXED_SQUARE_VERTICES;
+	}
+	elements.buffer(indices, baseVertex);
+}
+
+} // tetragon::graphics
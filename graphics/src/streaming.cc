@@ -0,0 +1,176 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "state.hpp"
+#include "streaming.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	constexpr GLbitfield PERSISTENT_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	constexpr GLbitfield STREAM_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+	constexpr GLuint64 FENCE_WAIT_TIMEOUT = 1'000'000;
+
+	std::size_t align_up(const std::size_t size, const std::size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+}
+
+StreamingStorage::StreamingStorage(const std::size_t regionSize, const std::size_t alignment):
+		m_alignment(alignment),
+		m_regionSize(align_up(std::max(regionSize, MIN_REGION_SIZE), alignment)),
+		m_persistent(is_persistent_supported()) {
+	allocate();
+	spdlog::info("Created {} streaming storage with {} regions of {} bytes",
+		m_persistent ? "persistent" : "orphaning", FRAME_REGIONS, m_regionSize);
+}
+
+StreamingStorage::~StreamingStorage() {
+	release();
+}
+
+bool StreamingStorage::is_persistent_supported() {
+	return GLAD_GL_ARB_buffer_storage;
+}
+
+GLObject StreamingStorage::object() const {
+	return m_object;
+}
+
+bool StreamingStorage::is_persistent() const {
+	return m_persistent;
+}
+
+std::size_t StreamingStorage::region_size() const {
+	return m_regionSize;
+}
+
+std::size_t StreamingStorage::frame_offset() const {
+	return m_frameOffset;
+}
+
+uint StreamingStorage::stalls() const {
+	return m_stalls;
+}
+
+void StreamingStorage::allocate() {
+	const std::size_t size = m_regionSize * FRAME_REGIONS;
+	glGenBuffers(1, &m_object);
+	GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+	if (m_persistent) {
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, PERSISTENT_MAP_FLAGS);
+		m_mapped = static_cast<byte*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, PERSISTENT_MAP_FLAGS));
+		if (m_mapped == nullptr) {
+			spdlog::error("Failed to persistently map {} bytes of streaming storage", size);
+			throw std::runtime_error("Failed to map streaming storage");
+		}
+	} else {
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	}
+	m_region = 0;
+	m_cursor = 0;
+	m_frameOffset = 0;
+}
+
+void StreamingStorage::release() {
+	for (GLsync& fence : m_fences) {
+		if (fence == nullptr) continue;
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	if (m_mapped != nullptr) {
+		GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		m_mapped = nullptr;
+	}
+	GLStateCache::current().forget_buffer(m_object);
+	glDeleteBuffers(1, &m_object);
+	m_object = 0;
+}
+
+void StreamingStorage::wait_region(const uint region) {
+	GLsync& fence = m_fences[region];
+	if (fence == nullptr) return;
+
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	if (status == GL_TIMEOUT_EXPIRED) {
+		m_stalls++;
+		do {
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+		} while (status == GL_TIMEOUT_EXPIRED);
+	}
+	if (status == GL_WAIT_FAILED) {
+		spdlog::error("Failed to wait for streaming storage region {}", region);
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void StreamingStorage::begin_frame() {
+	if (!m_persistent) return;
+	m_region = (m_region + 1) % FRAME_REGIONS;
+	wait_region(m_region);
+	m_frameOffset = m_region * m_regionSize;
+}
+
+void StreamingStorage::end_frame() {
+	if (!m_persistent) return;
+	if (m_fences[m_region] != nullptr) {
+		glDeleteSync(m_fences[m_region]);
+	}
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamingStorage::byte* StreamingStorage::frame_pointer() const {
+	return m_mapped + m_frameOffset;
+}
+
+void StreamingStorage::upload(const void* ptr, const std::size_t size) {
+	if (size == 0) return;
+	const std::size_t capacity = m_regionSize * FRAME_REGIONS;
+	if (size > capacity) {
+		grow(size, 0);
+	}
+
+	GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+	if (m_cursor + size > capacity) {
+		glBufferData(GL_ARRAY_BUFFER, m_regionSize * FRAME_REGIONS, nullptr, GL_STREAM_DRAW);
+		m_cursor = 0;
+	}
+	void* destination = glMapBufferRange(GL_ARRAY_BUFFER, m_cursor, size, STREAM_MAP_FLAGS);
+	if (destination == nullptr) {
+		spdlog::error("Failed to map {} bytes of streaming storage at offset {}", size, m_cursor);
+		throw std::runtime_error("Failed to map streaming storage");
+	}
+	memcpy(destination, ptr, size);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+
+	m_frameOffset = m_cursor;
+	m_cursor = align_up(m_cursor + size, m_alignment);
+}
+
+void StreamingStorage::grow(const std::size_t regionSize, const std::size_t preservedSize) {
+	const std::size_t oldRegionSize = m_regionSize;
+	m_regionSize = align_up(std::max(regionSize, m_regionSize * 2), m_alignment);
+	spdlog::info("Expanded streaming storage region size: {} -> {}", oldRegionSize, m_regionSize);
+
+	if (!m_persistent) {
+		GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+		glBufferData(GL_ARRAY_BUFFER, m_regionSize * FRAME_REGIONS, nullptr, GL_STREAM_DRAW);
+		m_cursor = 0;
+		return;
+	}
+
+	std::vector<byte> preserved(frame_pointer(), frame_pointer() + preservedSize);
+	for (uint region = 0; region < FRAME_REGIONS; region++) {
+		wait_region(region);
+	}
+	release();
+	allocate();
+	memcpy(frame_pointer(), preserved.data(), preserved.size());
+}
+
+} // tetragon::graphics
@@ -0,0 +1,403 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+
+#include "tessellation.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	using Index = ElementBuffer::Index;
+
+	constexpr float EPSILON = 1e-12f;
+
+	void put(std::byte*& out, const float x, const float y, const float z) {
+		const float vertex[] { x, y, z };
+		memcpy(out, vertex, sizeof(vertex));
+		out += sizeof(vertex);
+	}
+
+	void put(std::byte*& out, Vector2 const& point, const float z) {
+		put(out, point.x, point.y, z);
+	}
+
+	float cross(Vector2 const& a, Vector2 const& b, Vector2 const& c) {
+		return (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+	}
+
+	float signed_area(const std::span<const Vector2> points) {
+		float area = 0;
+		for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+			area += points[j].x * points[i].y - points[i].x * points[j].y;
+		}
+		return area / 2;
+	}
+
+	bool is_convex(const std::span<const Vector2> points) {
+		int sign = 0;
+		const std::size_t n = points.size();
+		for (std::size_t i = 0; i < n; i++) {
+			const float turn = cross(points[i], points[(i + 1) % n], points[(i + 2) % n]);
+			if (turn == 0) continue;
+			const int current = turn > 0 ? 1 : -1;
+			if (sign != 0 && current != sign) return false;
+			sign = current;
+		}
+		return true;
+	}
+
+	bool contains(Vector2 const& a, Vector2 const& b, Vector2 const& c, Vector2 const& point) {
+		return cross(a, b, point) >= 0 && cross(b, c, point) >= 0 && cross(c, a, point) >= 0;
+	}
+
+	void tessellate_rectangle(Rectangle const& rectangle, std::byte*& vertices, Index*& indices, const Index first) {
+		put(vertices, rectangle.min.x, rectangle.min.y, rectangle.z);
+		put(vertices, rectangle.max.x, rectangle.min.y, rectangle.z);
+		put(vertices, rectangle.max.x, rectangle.max.y, rectangle.z);
+		put(vertices, rectangle.min.x, rectangle.max.y, rectangle.z);
+		for (const Index index : { 0, 1, 2, 0, 2, 3 }) {
+			*indices++ = first + index;
+		}
+	}
+
+	// Rim points are rotated incrementally instead of calling sin and cos
+	// per segment; the drift over MAX_SEGMENTS steps is far below tolerance.
+	void tessellate_ellipse(Ellipse const& ellipse, const uint segments, std::byte*& vertices, Index*& indices,
+			const Index first) {
+		const float step = 2 * std::numbers::pi_v<float> / static_cast<float>(segments);
+		const float cosine = std::cos(step), sine = std::sin(step);
+		float x = 1, y = 0;
+		put(vertices, ellipse.center, ellipse.z);
+		for (uint i = 0; i < segments; i++) {
+			put(vertices, ellipse.center.x + x * ellipse.radii.x, ellipse.center.y + y * ellipse.radii.y, ellipse.z);
+			const float rotatedX = x * cosine - y * sine;
+			y = x * sine + y * cosine;
+			x = rotatedX;
+
+			*indices++ = first;
+			*indices++ = first + 1 + i;
+			*indices++ = first + 1 + (i + 1) % segments;
+		}
+	}
+
+	// Convex polygons are fanned from their first point. Others are ear
+	// clipped in counter-clockwise order; if no ear is found, e.g. for a
+	// self-intersecting outline, the current corner is clipped anyway so the
+	// index count always stays 3 * (n - 2).
+	void tessellate_polygon(const std::span<const Vector2> points, const float z, std::vector<Index>& ring,
+			std::byte*& vertices, Index*& indices, const Index first) {
+		for (Vector2 const& point : points) {
+			put(vertices, point, z);
+		}
+		const auto n = static_cast<Index>(points.size());
+		const bool clockwise = signed_area(points) < 0;
+
+		if (is_convex(points)) {
+			for (Index i = 1; i + 1 < n; i++) {
+				*indices++ = first;
+				*indices++ = first + (clockwise ? i + 1 : i);
+				*indices++ = first + (clockwise ? i : i + 1);
+			}
+			return;
+		}
+
+		ring.resize(n);
+		for (Index i = 0; i < n; i++) {
+			ring[i] = clockwise ? n - 1 - i : i;
+		}
+		std::size_t corner = 0, attempts = 0;
+		while (ring.size() > 3) {
+			const std::size_t size = ring.size();
+			corner %= size;
+			const Index a = ring[(corner + size - 1) % size], b = ring[corner], c = ring[(corner + 1) % size];
+
+			bool ear = cross(points[a], points[b], points[c]) > 0;
+			for (std::size_t j = 0; ear && j < size; j++) {
+				const Vector2& point = points[ring[j]];
+				if (ring[j] == a || ring[j] == b || ring[j] == c) continue;
+				if (point == points[a] || point == points[b] || point == points[c]) continue;
+				ear = !contains(points[a], points[b], points[c], point);
+			}
+			if (!ear && ++attempts < size) {
+				corner++;
+				continue;
+			}
+			*indices++ = first + a;
+			*indices++ = first + b;
+			*indices++ = first + c;
+			ring.erase(ring.begin() + static_cast<std::ptrdiff_t>(corner));
+			attempts = 0;
+		}
+		*indices++ = first + ring[0];
+		*indices++ = first + ring[1];
+		*indices++ = first + ring[2];
+	}
+
+	// Every point gets two vertices, offset along the miter of its adjacent
+	// segments. Miters of sharp corners are limited to MITER_LIMIT times the
+	// half width.
+	void tessellate_polyline(const std::span<const Vector2> points, TessellationBatch::Path const& path,
+			std::vector<Vector2>& normals, std::byte*& vertices, Index*& indices, const Index first) {
+		const std::size_t n = points.size();
+		const std::size_t segments = path.closed ? n : n - 1;
+		normals.resize(segments);
+		Vector2 previous = vec(0.f, 1.f);
+		for (std::size_t i = 0; i < segments; i++) {
+			const Vector2 direction = points[(i + 1) % n] - points[i];
+			const float length = direction.length();
+			normals[i] = length > EPSILON ? vec(-direction.y / length, direction.x / length) : previous;
+			previous = normals[i];
+		}
+
+		const float halfWidth = path.width / 2;
+		for (std::size_t i = 0; i < n; i++) {
+			const bool hasPrevious = path.closed || i > 0;
+			const bool hasNext = path.closed || i + 1 < n;
+			const Vector2 before = normals[hasPrevious ? (i + segments - 1) % segments : i];
+			const Vector2 after = normals[hasNext ? i % segments : i - 1];
+
+			Vector2 miter = before + after;
+			const float length = miter.length();
+			float scale = 1;
+			if (length > EPSILON) {
+				miter = miter / length;
+				scale = std::min(1 / std::max(dot(miter, after), EPSILON), Tessellator::MITER_LIMIT);
+			} else {
+				miter = after;
+			}
+			const Vector2 offset = miter * (scale * halfWidth);
+			put(vertices, points[i] + offset, path.z);
+			put(vertices, points[i] - offset, path.z);
+		}
+
+		for (std::size_t i = 0; i < segments; i++) {
+			const auto a = static_cast<Index>(2 * i), b = static_cast<Index>(2 * ((i + 1) % n));
+			for (const Index index : { a, Index(a + 1), b, b, Index(a + 1), Index(b + 1) }) {
+				*indices++ = first + index;
+			}
+		}
+	}
+}
+
+void TessellationBatch::add(Rectangle const& rectangle) {
+	m_rectangles.push_back(rectangle);
+}
+
+void TessellationBatch::add(Ellipse const& ellipse) {
+	m_ellipses.push_back(ellipse);
+}
+
+void TessellationBatch::add_circle(const Vector2 center, const float radius, const float z) {
+	m_ellipses.push_back({ center, vec(radius, radius), z });
+}
+
+void TessellationBatch::add_polygon(const std::span<const Vector2> points, const float z) {
+	if (points.size() < 3) {
+		spdlog::error("Failed to add a polygon with {} points, as it needs at least 3", points.size());
+		throw std::invalid_argument("Polygon needs at least three points");
+	}
+	m_polygons.push_back({ m_points.size(), points.size(), z, 0, true });
+	m_points.insert(m_points.end(), points.begin(), points.end());
+}
+
+void TessellationBatch::add_polyline(const std::span<const Vector2> points, const float width, const bool closed,
+		const float z) {
+	if (points.size() < 2 || width <= 0) {
+		spdlog::error("Failed to add a polyline with {} points and width {}", points.size(), width);
+		throw std::invalid_argument("Polyline needs at least two points and a positive width");
+	}
+	m_polylines.push_back({ m_points.size(), points.size(), z, width, closed });
+	m_points.insert(m_points.end(), points.begin(), points.end());
+}
+
+std::span<const Rectangle> TessellationBatch::rectangles() const {
+	return m_rectangles;
+}
+
+std::span<const Ellipse> TessellationBatch::ellipses() const {
+	return m_ellipses;
+}
+
+std::span<const TessellationBatch::Path> TessellationBatch::polygons() const {
+	return m_polygons;
+}
+
+std::span<const TessellationBatch::Path> TessellationBatch::polylines() const {
+	return m_polylines;
+}
+
+std::span<const Vector2> TessellationBatch::points() const {
+	return m_points;
+}
+
+std::size_t TessellationBatch::size() const {
+	return m_rectangles.size() + m_ellipses.size() + m_polygons.size() + m_polylines.size();
+}
+
+bool TessellationBatch::empty() const {
+	return size() == 0;
+}
+
+void TessellationBatch::clear() {
+	m_rectangles.clear();
+	m_ellipses.clear();
+	m_polygons.clear();
+	m_polylines.clear();
+	m_points.clear();
+}
+
+Tessellator::Tessellator(const float tolerance, jobs::Scheduler& scheduler):
+		m_tolerance(tolerance),
+		m_scheduler(scheduler) {
+	set_tolerance(tolerance);
+}
+
+float Tessellator::tolerance() const {
+	return m_tolerance;
+}
+
+void Tessellator::set_tolerance(const float tolerance) {
+	if (!(tolerance > 0)) {
+		spdlog::error("Failed to set tessellation tolerance {}, as it must be positive", tolerance);
+		throw std::invalid_argument("Tessellation tolerance must be positive");
+	}
+	m_tolerance = tolerance;
+}
+
+// A chord over the angle 2 * acos(1 - tolerance / radius) deviates from
+// the arc by exactly the tolerance, measured at the larger radius.
+uint Tessellator::segment_count(Ellipse const& ellipse, const float tolerance) {
+	const float radius = std::max(std::abs(ellipse.radii.x), std::abs(ellipse.radii.y));
+	if (radius <= tolerance) return MIN_SEGMENTS;
+	const float angle = 2 * std::acos(1 - tolerance / radius);
+	const float segments = std::ceil(2 * std::numbers::pi_v<float> / angle);
+	return static_cast<uint>(std::clamp(segments, float(MIN_SEGMENTS), float(MAX_SEGMENTS)));
+}
+
+Tessellator::Range Tessellator::tessellate(TessellationBatch const& batch, VertexBuffer& buffer,
+		ElementBuffer& elements) {
+	const auto start = std::chrono::steady_clock::now();
+	if (buffer.vertex_size() != sizeof(Vector3)) {
+		spdlog::error("Failed to tessellate into a buffer with vertex size {}, as tessellated vertices are Vector3",
+			buffer.vertex_size());
+		throw std::invalid_argument("Tessellation needs a Vector3 vertex buffer");
+	}
+
+	Range range { buffer.vertex_count(), 0, elements.count(), 0 };
+	const std::size_t vertexCount = plan(batch);
+	std::size_t chunks = 0;
+	if (vertexCount > 0) {
+		chunks = tessellate_items(batch, buffer.stage(vertexCount).data());
+		elements.buffer(m_indices, range.firstVertex);
+	}
+
+	range.vertexCount = static_cast<uint>(vertexCount);
+	range.indexCount = m_indices.size();
+	m_statistics = {
+		batch.size(), vertexCount, m_indices.size(), chunks,
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+	};
+	return range;
+}
+
+std::span<const ElementBuffer::Index> Tessellator::tessellate(TessellationBatch const& batch,
+		std::vector<Vector3>& vertices) {
+	const auto start = std::chrono::steady_clock::now();
+	const std::size_t vertexCount = plan(batch);
+	vertices.resize(vertexCount);
+	std::size_t chunks = 0;
+	if (vertexCount > 0) {
+		chunks = tessellate_items(batch, reinterpret_cast<std::byte*>(vertices.data()));
+	}
+
+	m_statistics = {
+		batch.size(), vertexCount, m_indices.size(), chunks,
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+	};
+	return m_indices;
+}
+
+Tessellator::Statistics const& Tessellator::statistics() const {
+	return m_statistics;
+}
+
+std::size_t Tessellator::plan(TessellationBatch const& batch) {
+	m_items.clear();
+	m_items.reserve(batch.size());
+	std::size_t vertexCount = 0, indexCount = 0;
+	const auto append = [&](const Kind kind, const std::size_t index, const std::size_t segments,
+			const std::size_t vertices, const std::size_t indices) {
+		m_items.push_back({ kind, static_cast<uint>(index), static_cast<uint>(segments),
+			static_cast<uint>(vertexCount), indexCount });
+		vertexCount += vertices;
+		indexCount += indices;
+	};
+
+	for (std::size_t i = 0; i < batch.rectangles().size(); i++) {
+		append(Kind::RECTANGLE, i, 0, 4, 6);
+	}
+	for (std::size_t i = 0; i < batch.ellipses().size(); i++) {
+		const uint segments = segment_count(batch.ellipses()[i], m_tolerance);
+		append(Kind::ELLIPSE, i, segments, segments + 1, 3 * segments);
+	}
+	for (std::size_t i = 0; i < batch.polygons().size(); i++) {
+		const std::size_t n = batch.polygons()[i].count;
+		append(Kind::POLYGON, i, 0, n, 3 * (n - 2));
+	}
+	for (std::size_t i = 0; i < batch.polylines().size(); i++) {
+		const TessellationBatch::Path& path = batch.polylines()[i];
+		const std::size_t segments = path.closed ? path.count : path.count - 1;
+		append(Kind::POLYLINE, i, segments, 2 * path.count, 6 * segments);
+	}
+
+	m_indices.resize(indexCount);
+	return vertexCount;
+}
+
+std::size_t Tessellator::tessellate_items(TessellationBatch const& batch, std::byte* vertices) {
+	std::atomic<std::size_t> chunks = 0;
+	Index* indices = m_indices.data();
+	m_scheduler.parallel_for(0, m_items.size(), MIN_CHUNK_SHAPES,
+		[&](const std::size_t begin, const std::size_t end) {
+			tessellate_range(batch, begin, end, vertices, indices);
+			chunks.fetch_add(1, std::memory_order_relaxed);
+		});
+	return chunks.load();
+}
+
+void Tessellator::tessellate_range(TessellationBatch const& batch, const std::size_t begin, const std::size_t end,
+		std::byte* vertices, Index* indices) const {
+	std::vector<Index> ring;
+	std::vector<Vector2> normals;
+	for (std::size_t i = begin; i < end; i++) {
+		Item const& item = m_items[i];
+		std::byte* vertexOut = vertices + item.firstVertex * sizeof(Vector3);
+		Index* indexOut = indices + item.firstIndex;
+		switch (item.kind) {
+			case Kind::RECTANGLE:
+				tessellate_rectangle(batch.rectangles()[item.index], vertexOut, indexOut, item.firstVertex);
+				break;
+			case Kind::ELLIPSE:
+				tessellate_ellipse(batch.ellipses()[item.index], item.segments, vertexOut, indexOut, item.firstVertex);
+				break;
+			case Kind::POLYGON: {
+				const TessellationBatch::Path& path = batch.polygons()[item.index];
+				tessellate_polygon(batch.points().subspan(path.first, path.count), path.z, ring,
+					vertexOut, indexOut, item.firstVertex);
+				break;
+			}
+			case Kind::POLYLINE: {
+				const TessellationBatch::Path& path = batch.polylines()[item.index];
+				tessellate_polyline(batch.points().subspan(path.first, path.count), path, normals,
+					vertexOut, indexOut, item.firstVertex);
+				break;
+			}
+		}
+	}
+}
+
+} // tetragon::graphics
@@ -0,0 +1,145 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "variants.hpp"
+
+namespace tetragon::graphics {
+
+namespace {
+	// Returns the name of an `#include "name"` or `#include <name>`
+	// directive, or an empty view for any other line
+	std::string_view include_name(const std::string_view line) {
+		std::size_t position = line.find_first_not_of(" \t");
+		if (position == std::string_view::npos || line[position] != '#') return {};
+		position = line.find_first_not_of(" \t", position + 1);
+		if (position == std::string_view::npos || line.substr(position, 7) != "include") return {};
+		position = line.find_first_not_of(" \t", position + 7);
+		if (position == std::string_view::npos) return {};
+
+		const char close = line[position] == '<' ? '>' : '"';
+		if (line[position] != '"' && line[position] != '<') return {};
+		const std::size_t end = line.find(close, position + 1);
+		if (end == std::string_view::npos) return {};
+		return line.substr(position + 1, end - position - 1);
+	}
+}
+
+ShaderPreprocessor& ShaderPreprocessor::add_include(std::string name, std::string source) {
+	m_includes.insert_or_assign(std::move(name), std::move(source));
+	return *this;
+}
+
+bool ShaderPreprocessor::has_include(std::string const& name) const {
+	return m_includes.contains(name);
+}
+
+std::string ShaderPreprocessor::process(const std::string_view source) const {
+	std::string output;
+	output.reserve(source.size());
+	std::vector<std::string_view> included;
+	process(source, output, included, 0);
+	return output;
+}
+
+void ShaderPreprocessor::process(const std::string_view source, std::string& output,
+		std::vector<std::string_view>& included, const uint depth) const {
+	if (depth > MAX_INCLUDE_DEPTH) {
+		spdlog::error("Shader includes are nested deeper than {} levels", MAX_INCLUDE_DEPTH);
+		throw std::runtime_error("Shader includes are nested too deep");
+	}
+
+	uint lineNumber = 0;
+	for (std::size_t begin = 0; begin < source.size();) {
+		std::size_t end = source.find('\n', begin);
+		end = end == std::string_view::npos ? source.size() : end + 1;
+		const std::string_view line = source.substr(begin, end - begin);
+		begin = end;
+		lineNumber++;
+
+		const std::string_view name = include_name(line);
+		if (name.empty()) {
+			output += line;
+			if (!line.ends_with('\n')) output += '\n';
+			continue;
+		}
+
+		const auto include = m_includes.find(std::string(name));
+		if (include == m_includes.end()) {
+			spdlog::error("Could not find shader include `{}`", name);
+			throw std::runtime_error("Missing shader include");
+		}
+		if (std::ranges::find(included, include->first) != included.end()) continue;
+		included.push_back(include->first);
+
+		process(include->second, output, included, depth + 1);
+		output += fmt::format("#line {}\n", lineNumber + 1);
+	}
+}
+
+ShaderVariants::ShaderVariants(std::vector<ShaderSource> sources,
+		ShaderPreprocessor const& preprocessor, ProgramBinaryCache* cache):
+		m_sources(std::move(sources)),
+		m_cache(cache) {
+	for (ShaderSource& source : m_sources) {
+		source.source = preprocessor.process(source.source);
+	}
+}
+
+ShaderVariantKey ShaderVariants::add_feature(std::string define) {
+	if (const ShaderVariantKey existing = feature(define); existing.bits() != 0) {
+		return existing;
+	}
+	if (m_features.size() >= ShaderVariantKey::MAX_FEATURES) {
+		spdlog::error("Cannot register feature `{}`: at most {} features are supported",
+			define, ShaderVariantKey::MAX_FEATURES);
+		throw std::out_of_range("Too many shader features");
+	}
+	m_features.push_back(std::move(define));
+	return ShaderVariantKey(std::uint64_t(1) << (m_features.size() - 1));
+}
+
+ShaderVariantKey ShaderVariants::feature(const std::string_view define) const {
+	const auto it = std::ranges::find(m_features, define);
+	if (it == m_features.end()) return {};
+	return ShaderVariantKey(std::uint64_t(1) << (it - m_features.begin()));
+}
+
+ShaderProgram& ShaderVariants::get(const ShaderVariantKey key) {
+	if (const auto it = m_programs.find(key.bits()); it != m_programs.end()) {
+		return *it->second;
+	}
+	if (m_features.size() < ShaderVariantKey::MAX_FEATURES && (key.bits() >> m_features.size()) != 0) {
+		spdlog::error("Shader variant {:#x} uses unregistered features", key.bits());
+		throw std::invalid_argument("Unregistered shader feature");
+	}
+
+	ShaderProgram::Builder builder;
+	for (ShaderSource const& source : m_sources) {
+		builder.attach_source(source.type, source.source);
+	}
+	for (std::size_t i = 0; i < m_features.size(); i++) {
+		if (key.has(ShaderVariantKey(std::uint64_t(1) << i))) {
+			builder.add_define(m_features[i]);
+		}
+	}
+
+	auto program = std::unique_ptr<ShaderProgram>(new ShaderProgram(
+		m_cache != nullptr ? builder.build(*m_cache) : builder.build()));
+	spdlog::debug("Compiled shader variant {:#x}", key.bits());
+	return *m_programs.emplace(key.bits(), std::move(program)).first->second;
+}
+
+bool ShaderVariants::contains(const ShaderVariantKey key) const {
+	return m_programs.contains(key.bits());
+}
+
+std::size_t ShaderVariants::size() const {
+	return m_programs.size();
+}
+
+void ShaderVariants::clear() {
+	m_programs.clear();
+}
+
+} // tetragon::graphics
@@ -1,8 +1,16 @@
 #include <spdlog/spdlog.h>
 #include <fmt/color.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 #include "vertices.hpp"
+#include "allocators.hpp"
+#include "elements.hpp"
 #include "shaders.hpp"
+#include "state.hpp"
+#include "streaming.hpp"
 
 namespace tetragon::graphics {
 
@@ -18,41 +26,189 @@ namespace tetragon::graphics {
 		glGenVertexArrays(1, &array);
 		return array;
 	}
+
+	void set_attribute_pointer(const uint location, VertexAttribute const& attribute) {
+		glVertexAttribPointer(location, attribute.size(), attribute.type(), attribute.normalized(),
+			attribute.stride(), reinterpret_cast<const void*>(static_cast<std::uintptr_t>(attribute.offset())));
+		glVertexAttribDivisor(location, attribute.divisor());
+	}
 }
 
 VertexBuffer::VertexBuffer(const std::size_t vertexSize): VertexBuffer(vertexSize, Usage::STATIC) {}
 
 VertexBuffer::VertexBuffer(const std::size_t vertexSize, const Usage usage):
-		m_object(create_vertex_buffer()),
+		VertexBuffer(vertexSize, usage, DEFAULT_CAPACITY, StagingAllocator::heap()) {}
+
+VertexBuffer::VertexBuffer(const std::size_t vertexSize, const Usage usage, const std::size_t initialCapacity,
+		StagingAllocator& allocator):
 		m_vertexSize(vertexSize),
+		m_allocator(&allocator),
+		m_maxSize(std::max<std::size_t>(initialCapacity, 1) * vertexSize),
 		m_usage(usage) {
-	m_buffer = new byte[m_maxSize] {};
-	m_ptr = m_buffer;
+	m_buffer = static_cast<byte*>(m_allocator->allocate(m_maxSize));
 	m_name = "Buffer";
+	create_storage();
 	bind();
 }
 
 VertexBuffer::~VertexBuffer() {
-	glDeleteBuffers(1, &m_object);
-	delete[] m_buffer;
+	release_storage();
+	m_allocator->deallocate(m_buffer, m_maxSize);
+}
+
+void VertexBuffer::create_storage() {
+	if (m_usage != Usage::STREAM) {
+		m_object = create_vertex_buffer();
+		return;
+	}
+	m_stream = std::make_unique<StreamingStorage>(m_maxSize, m_vertexSize);
+	m_object = m_stream->object();
+	if (!m_stream->is_persistent()) return;
+
+	m_stream->begin_frame();
+	memcpy(m_stream->frame_pointer(), m_buffer, m_size);
+	m_allocator->deallocate(m_buffer, m_maxSize);
+	m_buffer = nullptr;
+	m_maxSize = m_stream->region_size();
+}
+
+void VertexBuffer::release_storage() {
+	if (m_stream == nullptr) {
+		GLStateCache::current().forget_buffer(m_object);
+		glDeleteBuffers(1, &m_object);
+		return;
+	}
+	if (m_stream->is_persistent()) {
+		m_buffer = static_cast<byte*>(m_allocator->allocate(m_maxSize));
+		memcpy(m_buffer, m_stream->frame_pointer(), m_size);
+	}
+	m_stream.reset();
+}
+
+VertexBuffer::byte* VertexBuffer::storage() const {
+	return is_persistent() ? m_stream->frame_pointer() : m_buffer;
 }
 
-void VertexBuffer::ensure_capacity(const uint additionalSize) {
-	if (m_size + additionalSize < m_maxSize) return;
-	m_maxSize *= 2;
+bool VertexBuffer::is_persistent() const {
+	return m_stream != nullptr && m_stream->is_persistent();
+}
 
-	auto expandedBuffer = new byte[m_maxSize];
-	memcpy(expandedBuffer, m_buffer, m_size);
-	delete[] m_buffer;
-	m_buffer = expandedBuffer;
-	m_ptr = m_buffer + m_size;
+void VertexBuffer::reallocate(const std::size_t maxSize) {
+	spdlog::info("Expanded {} size: {} -> {}", m_name, m_maxSize, maxSize);
+	if (is_persistent()) {
+		m_stream->grow(maxSize, m_size);
+		m_maxSize = m_stream->region_size();
+		m_object = m_stream->object();
+		apply_attributes();
+		return;
+	}
 
-	glBufferData(GL_ARRAY_BUFFER, m_size, m_buffer, (GLenum) m_usage);
-	spdlog::info("Expanded {} size: {} -> {}", m_name, m_maxSize / 2, m_maxSize);
+	m_buffer = static_cast<byte*>(m_allocator->reallocate(m_buffer, m_maxSize, m_size, maxSize));
+	m_maxSize = maxSize;
 }
 
-void VertexBuffer::bind() const {
-	glBindBuffer(GL_ARRAY_BUFFER, m_object);
+void VertexBuffer::ensure_capacity(const std::size_t additionalSize) {
+	if (m_size + additionalSize <= m_maxSize) return;
+	std::size_t maxSize = m_maxSize;
+	while (m_size + additionalSize > maxSize) {
+		maxSize *= 2;
+	}
+	reallocate(maxSize);
+}
+
+void VertexBuffer::reserve(const std::size_t vertexCount) {
+	const std::size_t maxSize = vertexCount * m_vertexSize;
+	if (maxSize <= m_maxSize) return;
+	reallocate(maxSize);
+}
+
+void VertexBuffer::clear() {
+	m_size = 0;
+	m_dirty.clear();
+}
+
+bool VertexBuffer::is_dirty() const {
+	return !m_dirty.empty();
+}
+
+void VertexBuffer::mark_dirty(const uint begin, const uint end) {
+	if (begin >= end || is_persistent()) return;
+	if (!m_dirty.empty()) {
+		DirtyRange& last = m_dirty.back();
+		if (begin <= last.end && end >= last.begin) {
+			last.begin = std::min(last.begin, begin);
+			last.end = std::max(last.end, end);
+			return;
+		}
+	}
+	m_dirty.push_back({ begin, end });
+}
+
+void VertexBuffer::bind() {
+	GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+	flush();
+}
+
+void VertexBuffer::flush() {
+	if (m_dirty.empty()) return;
+
+	if (m_stream != nullptr) {
+		m_stream->upload(m_buffer, m_size);
+		m_dirty.clear();
+		return;
+	}
+
+	GLStateCache::current().bind_buffer(GL_ARRAY_BUFFER, m_object);
+	if (m_maxSize > m_gpuSize) {
+		glBufferData(GL_ARRAY_BUFFER, m_maxSize, m_buffer, (GLenum) m_usage);
+		m_gpuSize = m_maxSize;
+		m_dirty.clear();
+		return;
+	}
+
+	std::sort(m_dirty.begin(), m_dirty.end(), [](DirtyRange const& a, DirtyRange const& b) {
+		return a.begin < b.begin;
+	});
+	uint uploads = 0, uploaded = 0;
+	DirtyRange current = m_dirty.front();
+	for (std::size_t i = 1; i <= m_dirty.size(); i++) {
+		if (i < m_dirty.size() && m_dirty[i].begin <= current.end + FLUSH_MERGE_GAP) {
+			current.end = std::max(current.end, m_dirty[i].end);
+			continue;
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, current.begin, current.end - current.begin, m_buffer + current.begin);
+		uploads++;
+		uploaded += current.end - current.begin;
+		if (i < m_dirty.size()) current = m_dirty[i];
+	}
+	m_dirty.clear();
+
+	spdlog::debug(" {}: flushed {} bytes in {} uploads", m_name, uploaded, uploads);
+}
+
+void VertexBuffer::begin_frame() {
+	if (m_stream != nullptr) {
+		m_stream->begin_frame();
+	}
+	clear();
+}
+
+void VertexBuffer::end_frame() {
+	if (m_stream != nullptr) {
+		m_stream->end_frame();
+	}
+}
+
+bool VertexBuffer::is_streaming() const {
+	return m_stream != nullptr;
+}
+
+uint VertexBuffer::first_vertex() const {
+	return m_stream != nullptr ? m_stream->frame_offset() / m_vertexSize : 0;
+}
+
+uint VertexBuffer::vertex_count() const {
+	return m_size / m_vertexSize;
 }
 
 void VertexBuffer::add_attribute(VertexAttribute const& attribute) {
@@ -62,14 +218,40 @@ void VertexBuffer::add_attribute(VertexAttribute const& attribute) {
 	}
 	ShaderProgram& shaderProgram = *ShaderProgram::get_bound_instance();
 	uint layoutLocation = shaderProgram.get_attribute_location(attribute);
+	if (layoutLocation == static_cast<uint>(-1)) {
+		spdlog::warn("Skipping attribute `{}`, as the bound shader program does not use it", attribute.name());
+		return;
+	}
+
+	const GLObject vertexArray = GLStateCache::current().vertex_array();
+	m_attributes.push_back({ layoutLocation, attribute, vertexArray });
 
 	bind();
-	glVertexAttribPointer(layoutLocation, attribute.size(), attribute.type(),
-		attribute.normalized(), attribute.stride(), nullptr);
+	set_attribute_pointer(layoutLocation, attribute);
 	glEnableVertexAttribArray(layoutLocation);
 
-	m_name = fmt::format("Buffer({})",
-	fmt::format(fmt::fg(fmt::color::aqua), "`{}`", attribute.name()));
+	std::vector<std::string> names;
+	for (AttributeBinding const& binding : m_attributes) {
+		names.push_back(fmt::format(fmt::fg(fmt::color::aqua), "`{}`", binding.attribute.name()));
+	}
+	m_name = fmt::format("Buffer({})", fmt::join(names, ", "));
+}
+
+void VertexBuffer::layout_mismatch(const std::size_t stride) const {
+	spdlog::error("Failed to add layout with stride {} to {}, as its vertex size is {}",
+		stride, m_name, m_vertexSize);
+	throw std::invalid_argument("Vertex layout stride does not match vertex size");
+}
+
+void VertexBuffer::apply_attributes() {
+	GLStateCache& state = GLStateCache::current();
+	const GLObject boundVertexArray = state.vertex_array();
+	state.bind_buffer(GL_ARRAY_BUFFER, m_object);
+	for (AttributeBinding const& binding : m_attributes) {
+		state.bind_vertex_array(binding.vertexArray);
+		set_attribute_pointer(binding.location, binding.attribute);
+	}
+	state.bind_vertex_array(boundVertexArray);
 }
 
 VertexBuffer::Usage VertexBuffer::usage() const {
@@ -77,24 +259,79 @@ VertexBuffer::Usage VertexBuffer::usage() const {
 }
 
 void VertexBuffer::set_usage(const Usage usage) {
+	if (m_usage == usage) return;
+	const bool streaming = usage == Usage::STREAM || m_usage == Usage::STREAM;
 	m_usage = usage;
+	m_gpuSize = 0;
+	if (streaming) {
+		release_storage();
+		create_storage();
+		apply_attributes();
+	}
+	mark_dirty(0, m_size);
 }
 
-void VertexBuffer::buffer(const void* ptr, const unsigned long size) {
-	std::vector oldBufferVector((float*) m_buffer, (float*) m_buffer + m_size / sizeof(float));
-	std::vector valuesVector((float*) ptr, (float*) ptr + size / sizeof(float));
+void VertexBuffer::append(const void* ptr, const std::size_t size) {
+	ensure_capacity(size);
+	memcpy(storage() + m_size, ptr, size);
+	mark_dirty(m_size, m_size + size);
+	m_size += size;
+}
 
+std::span<std::byte> VertexBuffer::stage(const std::size_t vertexCount) {
+	const std::size_t size = vertexCount * m_vertexSize;
 	ensure_capacity(size);
-	memcpy(m_ptr, ptr, size);
-	m_ptr += size;
+	auto* staged = reinterpret_cast<std::byte*>(storage() + m_size);
+	mark_dirty(m_size, m_size + size);
 	m_size += size;
-	bind();
-	glBufferData(GL_ARRAY_BUFFER, m_size, m_buffer, (GLenum) m_usage);
+	return { staged, size };
+}
+
+void VertexBuffer::update(const std::size_t offset, const void* ptr, const std::size_t size) {
+	if (offset + size > m_size) {
+		spdlog::error("Failed to update {} bytes at offset {} of {}, as it holds only {} bytes",
+			size, offset, m_name, m_size);
+		throw std::out_of_range("Updated range is outside of the buffered data");
+	}
+	memcpy(storage() + offset, ptr, size);
+	mark_dirty(offset, offset + size);
+}
+
+void VertexBuffer::buffer(const void* ptr, const unsigned long size) {
+	append(ptr, size);
+	if (m_stream != nullptr || !spdlog::should_log(spdlog::level::debug)) return;
+
+	spdlog::debug(" {}: {}",
+		m_name,
+		fmt::format(fg(fmt::color::green_yellow), "+{} bytes", size)
+	);
+}
+
+void VertexBuffer::buffer_bulk(const void* ptr, const std::size_t size) {
+	const uint begin = m_size;
+	ensure_capacity(size);
+	append(ptr, size);
+	commit_bulk(begin);
+}
+
+void VertexBuffer::commit_bulk(const uint begin) {
+	const uint size = m_size - begin;
+	if (size % m_vertexSize != 0) {
+		spdlog::error("Failed to buffer {} bytes to {}, as it is not a multiple of vertex size {}",
+			size, m_name, m_vertexSize);
+		m_size = begin;
+		std::erase_if(m_dirty, [begin](DirtyRange const& range) { return range.begin >= begin; });
+		for (DirtyRange& range : m_dirty) {
+			range.end = std::min(range.end, begin);
+		}
+		throw std::invalid_argument("Buffered data is not a whole number of vertices");
+	}
+	if (size == 0 || m_stream != nullptr || !spdlog::should_log(spdlog::level::debug)) return;
 
-	spdlog::debug(" {}: [ {:.1f}, {} ]",
+	spdlog::debug(" {}: {} ({} bytes)",
 		m_name,
-		fmt::join(oldBufferVector, ", "),
-		fmt::format(fg(fmt::color::green_yellow), "{:.1f}", fmt::join(valuesVector, ", "))
+		fmt::format(fg(fmt::color::green_yellow), "+{} vertices", size / m_vertexSize),
+		size
 	);
 }
 
@@ -111,17 +348,94 @@ VertexArray::VertexArray():
 }
 
 VertexArray::~VertexArray() {
+	GLStateCache::current().forget_vertex_array(m_object);
 	glDeleteVertexArrays(1, &m_object);
 }
 
 void VertexArray::bind() const {
-	glBindVertexArray(m_object);
+	GLStateCache::current().bind_vertex_array(m_object);
+}
+
+void VertexArray::draw_arrays(const uint first, const uint count, const GLenum mode) const {
+	bind();
+	glDrawArrays(mode, first, count);
+}
+
+void VertexArray::draw_elements(ElementBuffer& elements, const GLenum mode, const int baseVertex) const {
+	bind();
+	elements.bind();
+	if (baseVertex == 0) {
+		glDrawElements(mode, elements.count(), (GLenum) elements.index_type(), nullptr);
+	} else {
+		glDrawElementsBaseVertex(mode, elements.count(), (GLenum) elements.index_type(), nullptr, baseVertex);
+	}
+}
+
+void VertexArray::draw_instanced(const uint first, const uint count, const uint instanceCount, const GLenum mode) const {
+	bind();
+	glDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+void VertexArray::draw_elements_instanced(ElementBuffer& elements, const uint instanceCount,
+		const GLenum mode, const int baseVertex) const {
+	bind();
+	elements.bind();
+	glDrawElementsInstancedBaseVertex(mode, elements.count(), (GLenum) elements.index_type(), nullptr,
+		instanceCount, baseVertex);
+}
+
+InstanceBuffer::InstanceBuffer(const std::size_t instanceSize):
+		InstanceBuffer(instanceSize, VertexBuffer::Usage::DYNAMIC) {}
+
+InstanceBuffer::InstanceBuffer(const std::size_t instanceSize, const VertexBuffer::Usage usage, const uint divisor):
+		m_buffer(instanceSize, usage),
+		m_divisor(divisor) {
+	if (divisor == 0) {
+		spdlog::error("Failed to create an instance buffer with divisor 0");
+		throw std::invalid_argument("Instance buffer divisor must be positive");
+	}
+	if (usage == VertexBuffer::Usage::STREAM) {
+		spdlog::error("Failed to create a streamed instance buffer, as instanced draws cannot offset into its ring");
+		throw std::invalid_argument("Instance buffers cannot use stream usage");
+	}
+}
+
+VertexBuffer& InstanceBuffer::vertices() {
+	return m_buffer;
+}
+
+uint InstanceBuffer::divisor() const {
+	return m_divisor;
+}
+
+uint InstanceBuffer::instance_count() const {
+	return m_buffer.vertex_count() * m_divisor;
+}
+
+void InstanceBuffer::bind() {
+	m_buffer.bind();
+}
+
+void InstanceBuffer::flush() {
+	m_buffer.flush();
+}
+
+void InstanceBuffer::clear() {
+	m_buffer.clear();
+}
+
+void InstanceBuffer::reserve(const std::size_t instanceCount) {
+	m_buffer.reserve(instanceCount);
+}
+
+void InstanceBuffer::add_attribute(VertexAttribute const& attribute) {
+	m_buffer.add_attribute(attribute.with_divisor(m_divisor));
 }
 
 	VertexAttribute::VertexAttribute(const char* name, const uint size, const GLenum type,
-                                 const bool normalized, const uint stride):
+                                 const bool normalized, const uint stride, const uint offset, const uint divisor):
 	m_name(name), m_size(size), m_type(type),
-	m_normalized(normalized), m_stride(stride) {
+	m_normalized(normalized), m_stride(stride), m_offset(offset), m_divisor(divisor) {
 }
 
 const char* VertexAttribute::name() const {
@@ -144,6 +458,18 @@ uint VertexAttribute::stride() const {
 	return m_stride;
 }
 
+uint VertexAttribute::offset() const {
+	return m_offset;
+}
+
+uint VertexAttribute::divisor() const {
+	return m_divisor;
+}
+
+VertexAttribute VertexAttribute::with_divisor(const uint divisor) const {
+	return { m_name, m_size, m_type, m_normalized, m_stride, m_offset, divisor };
+}
+
 VertexAttribute::Builder& VertexAttribute::Builder::set_name(const char* name) {
 	m_name = name;
 	return *this;
@@ -169,8 +495,18 @@ VertexAttribute::Builder& VertexAttribute::Builder::set_stride(uint size) {
 	return *this;
 }
 
+VertexAttribute::Builder& VertexAttribute::Builder::set_offset(uint offset) {
+	m_offset = offset;
+	return *this;
+}
+
+VertexAttribute::Builder& VertexAttribute::Builder::set_divisor(uint divisor) {
+	m_divisor = divisor;
+	return *this;
+}
+
 VertexAttribute VertexAttribute::Builder::build() const {
-	return { m_name, m_size, m_type, m_normalized, m_stride };
+	return { m_name, m_size, m_type, m_normalized, m_stride, m_offset, m_divisor };
 }
 
 // Vertex::Vertex(const std::initializer_list<float> values) {
@@ -0,0 +1,135 @@
+#ifndef TETRAGON_JOBS_HPP
+#define TETRAGON_JOBS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tetragon::jobs {
+
+using Job = std::function<void()>;
+
+class Scheduler;
+
+// Number of unfinished jobs submitted with it. Jobs submitted after a
+// counter are held back until it reaches zero, and the first exception of
+// its jobs is rethrown by Scheduler::wait. A counter that has jobs must
+// outlive a wait on it.
+class Counter {
+	friend class Scheduler;
+
+	struct Continuation {
+		Job job;
+		Counter* counter;
+	};
+
+	std::atomic<std::size_t> m_value = 0;
+	std::mutex m_mutex;
+	std::vector<Continuation> m_continuations;
+	std::exception_ptr m_exception;
+
+public:
+	Counter() = default;
+	Counter(Counter const&) = delete;
+	Counter& operator=(Counter const&) = delete;
+
+	[[nodiscard]] bool done() const;
+	[[nodiscard]] std::size_t value() const;
+};
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops
+// its own jobs at the back and steals from the front of the others. Jobs
+// submitted from other threads go to a shared queue. Waiting threads run
+// queued jobs until their counter is done, so the main thread helps
+// instead of blocking and nested waits inside jobs cannot deadlock.
+class Scheduler final {
+	struct Task {
+		Job job;
+		Counter* counter;
+	};
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues;
+	std::vector<std::jthread> m_workers;
+	std::atomic<std::size_t> m_pending = 0;
+	std::atomic<bool> m_stopping = false;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake;
+
+public:
+	// Zero threads uses one worker less than there are hardware threads,
+	// leaving a core to the waiting main thread, but at least one worker.
+	explicit Scheduler(unsigned threads = 0);
+	~Scheduler();
+
+	Scheduler(Scheduler const&) = delete;
+	Scheduler& operator=(Scheduler const&) = delete;
+
+	static Scheduler& global();
+
+	[[nodiscard]] unsigned worker_count() const;
+
+	void submit(Job job, Counter* counter = nullptr);
+	void submit_after(Counter& dependency, Job job, Counter* counter = nullptr);
+
+	void wait(Counter& counter);
+
+	// Calls fn(first, last) on consecutive ranges of at least grain indices,
+	// in parallel, and returns once all of them are done.
+	template<class Fn>
+	void parallel_for(const std::size_t begin, const std::size_t end, const std::size_t grain, Fn&& fn) {
+		if (begin >= end) return;
+		const std::size_t count = end - begin;
+		const std::size_t maxChunks = (worker_count() + 1) * 4;
+		const std::size_t chunks = std::clamp<std::size_t>(count / std::max<std::size_t>(grain, 1), 1, maxChunks);
+		if (chunks == 1) {
+			fn(begin, end);
+			return;
+		}
+
+		const std::size_t chunkSize = (count + chunks - 1) / chunks;
+		Counter counter;
+		for (std::size_t first = begin + chunkSize; first < end; first += chunkSize) {
+			const std::size_t last = std::min(first + chunkSize, end);
+			submit([&fn, first, last] { fn(first, last); }, &counter);
+		}
+		std::exception_ptr exception;
+		try {
+			fn(begin, begin + chunkSize);
+		} catch (...) {
+			exception = std::current_exception();
+		}
+		wait(counter);
+		if (exception) std::rethrow_exception(exception);
+	}
+
+	template<class Fn>
+	void parallel_for(const std::size_t begin, const std::size_t end, Fn&& fn) {
+		parallel_for(begin, end, 1, std::forward<Fn>(fn));
+	}
+
+private:
+	void run_worker(std::size_t index);
+	bool run_one(std::size_t queue);
+	bool pop(std::size_t queue, Task& task);
+	void execute(Task& task);
+	void finish(Counter* counter, std::exception_ptr exception);
+	void push(Task task);
+};
+
+} // tetragon::jobs
+
+#endif // TETRAGON_JOBS_HPP
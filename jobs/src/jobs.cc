@@ -0,0 +1,172 @@
+#include <spdlog/spdlog.h>
+
+#include "jobs.hpp"
+
+namespace tetragon::jobs {
+
+namespace {
+	// Queue of the calling thread: workers own queues 1..n, all other
+	// threads share queue 0.
+	thread_local const Scheduler* t_scheduler = nullptr;
+	thread_local std::size_t t_queue = 0;
+}
+
+bool Counter::done() const {
+	return m_value.load(std::memory_order_acquire) == 0;
+}
+
+std::size_t Counter::value() const {
+	return m_value.load(std::memory_order_acquire);
+}
+
+Scheduler::Scheduler(const unsigned threads) {
+	const unsigned hardware = std::thread::hardware_concurrency();
+	const unsigned workers = threads != 0 ? threads : std::max(hardware, 2u) - 1;
+	for (unsigned i = 0; i <= workers; i++) {
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+	for (unsigned i = 1; i <= workers; i++) {
+		m_workers.emplace_back([this, i] { run_worker(i); });
+	}
+	spdlog::info("Started job scheduler with {} workers", workers);
+}
+
+Scheduler::~Scheduler() {
+	{
+		std::lock_guard lock(m_sleepMutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	m_workers.clear();
+}
+
+Scheduler& Scheduler::global() {
+	static Scheduler scheduler;
+	return scheduler;
+}
+
+unsigned Scheduler::worker_count() const {
+	return static_cast<unsigned>(m_workers.size());
+}
+
+void Scheduler::submit(Job job, Counter* counter) {
+	if (counter != nullptr) counter->m_value.fetch_add(1, std::memory_order_relaxed);
+	push({ std::move(job), counter });
+}
+
+void Scheduler::submit_after(Counter& dependency, Job job, Counter* counter) {
+	if (counter != nullptr) counter->m_value.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard lock(dependency.m_mutex);
+		if (!dependency.done()) {
+			dependency.m_continuations.push_back({ std::move(job), counter });
+			return;
+		}
+	}
+	push({ std::move(job), counter });
+}
+
+void Scheduler::wait(Counter& counter) {
+	const std::size_t queue = t_scheduler == this ? t_queue : 0;
+	// With nothing to steal, the remaining jobs are running on workers, so
+	// sleep until one of them changes the counter instead of spinning
+	while (!counter.done()) {
+		if (run_one(queue)) continue;
+		const std::size_t value = counter.m_value.load(std::memory_order_acquire);
+		if (value != 0) counter.m_value.wait(value, std::memory_order_acquire);
+	}
+	// The last job releases the counter's lock after its decrement, so
+	// taking it here keeps the counter alive until the job is done with it.
+	std::exception_ptr exception;
+	{
+		std::lock_guard lock(counter.m_mutex);
+		exception = std::exchange(counter.m_exception, nullptr);
+	}
+	if (exception) std::rethrow_exception(exception);
+}
+
+void Scheduler::run_worker(const std::size_t index) {
+	t_scheduler = this;
+	t_queue = index;
+	while (true) {
+		if (run_one(index)) continue;
+		std::unique_lock lock(m_sleepMutex);
+		m_wake.wait(lock, [this] { return m_pending.load() > 0 || m_stopping; });
+		if (m_stopping && m_pending.load() == 0) return;
+	}
+}
+
+bool Scheduler::run_one(const std::size_t queue) {
+	Task task;
+	for (std::size_t i = 0; i < m_queues.size(); i++) {
+		if (pop((queue + i) % m_queues.size(), task)) {
+			execute(task);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Owners take their newest job, which is likely still in cache; thieves
+// take the oldest, which tends to be the largest remaining piece of work.
+bool Scheduler::pop(const std::size_t queue, Task& task) {
+	const bool own = queue == (t_scheduler == this ? t_queue : 0);
+	Queue& source = *m_queues[queue];
+	std::lock_guard lock(source.mutex);
+	if (source.tasks.empty()) return false;
+	if (own) {
+		task = std::move(source.tasks.back());
+		source.tasks.pop_back();
+	} else {
+		task = std::move(source.tasks.front());
+		source.tasks.pop_front();
+	}
+	m_pending.fetch_sub(1);
+	return true;
+}
+
+void Scheduler::execute(Task& task) {
+	std::exception_ptr exception;
+	try {
+		task.job();
+	} catch (...) {
+		exception = std::current_exception();
+	}
+	finish(task.counter, exception);
+}
+
+void Scheduler::finish(Counter* counter, std::exception_ptr exception) {
+	if (counter == nullptr) {
+		if (exception) {
+			spdlog::error("Job without counter failed, its exception is dropped");
+		}
+		return;
+	}
+	std::vector<Counter::Continuation> continuations;
+	{
+		std::lock_guard lock(counter->m_mutex);
+		if (exception && !counter->m_exception) counter->m_exception = exception;
+		if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			continuations.swap(counter->m_continuations);
+		}
+		counter->m_value.notify_all();
+	}
+	for (Counter::Continuation& continuation : continuations) {
+		push({ std::move(continuation.job), continuation.counter });
+	}
+}
+
+void Scheduler::push(Task task) {
+	const std::size_t queue = t_scheduler == this ? t_queue : 0;
+	{
+		std::lock_guard lock(m_queues[queue]->mutex);
+		m_queues[queue]->tasks.push_back(std::move(task));
+	}
+	m_pending.fetch_add(1);
+	{
+		std::lock_guard lock(m_sleepMutex);
+	}
+	m_wake.notify_one();
+}
+
+} // tetragon::jobs
@@ -2,9 +2,13 @@
 
 in vec3 v_color;
 
+#ifdef TINT_GREEN
 uniform float u_green;
+#endif
 
 void main() {
 	gl_FragColor = vec4(v_color, 1);
+#ifdef TINT_GREEN
 	gl_FragColor.g *= u_green;
+#endif
 }
@@ -5,7 +5,10 @@ in vec3 pos;
 
 out vec3 v_color;
 
-uniform vec3 u_offset;
+layout(std140) uniform Globals {
+	vec3 u_offset;
+	float u_time;
+};
 
 void main() {
 	gl_Position = vec4(pos + u_offset, 1.0);
@@ -7,9 +7,15 @@
 #include <fmt/color.h>
 #include <tetragon/initializations.hpp>
 #include <tetragon/applications.hpp>
+#include <tetragon/graphics/binaries.hpp>
+#include <tetragon/graphics/blocks.hpp>
+#include <tetragon/graphics/formats.hpp>
+#include <tetragon/graphics/layouts.hpp>
 #include <tetragon/graphics/primitives.hpp>
 #include <tetragon/graphics/shaders.hpp>
 #include <tetragon/graphics/shapes.hpp>
+#include <tetragon/graphics/state.hpp>
+#include <tetragon/graphics/variants.hpp>
 
 #include "resources.hpp"
 
@@ -21,8 +27,15 @@ using namespace tetragon;
 using namespace tetragon::graphics;
 
 void postpone_closing(Window& window, int seconds);
-ShaderProgram create_shader_program();
-void update_uniforms(Uniform<float> u_green, Uniform<Vector3> u_offset);
+ShaderVariants create_shader_variants(ProgramBinaryCache& cache);
+
+struct Globals {
+	using Layout = Std140Layout<Vector3, float>;
+	Vector3 offset;
+	float time;
+};
+
+void update_uniforms(Uniform<float> u_green, UniformBlock<Globals>& globals);
 
 int main() {
 	init_logs();
@@ -36,7 +49,7 @@ int main() {
 		}
 
 		void on_resize(int oldWidth, int oldHeight) override {
-			glViewport(0, 0, width(), height());
+			GLStateCache::current().set_viewport(0, 0, width(), height());
 			std::string title = construct_title();
 			set_title(title.c_str());
 		}
@@ -71,42 +84,39 @@ int main() {
 	VertexArray VAO;
 	VAO.bind(); 
 
-	auto vertexSize = Vector3().vertex_size();
+	struct ColoredVertex {
+		Vector3 pos;
+		Unorm8x4 color;
+	};
+	using ColoredLayout = VertexLayout<Attribute<"pos", Vector3>, Attribute<"color", Unorm8x4>>;
+	static_assert(ColoredLayout::matches<ColoredVertex>);
+
 	constexpr auto usage = VertexBuffer::Usage::STATIC;
-	VertexBuffer vbo1(vertexSize, usage), vbo2(vertexSize, usage);
+	VertexBuffer vbo(ColoredLayout::stride, usage);
 
-	ShaderProgram shaderProgram = create_shader_program();
+	ProgramBinaryCache shaderCache(ProgramBinaryCache::default_directory());
+	ShaderVariants shaderVariants = create_shader_variants(shaderCache);
+	ShaderProgram& shaderProgram = shaderVariants.get(shaderVariants.feature("TINT_GREEN"));
 	shaderProgram.bind();
 
-	VertexAttribute::Builder vertexAttribBuilder = VertexAttribute::Builder()
-			.set_type(GL_FLOAT)
-			.set_size(3);
-
-	const VertexAttribute posAttrib = vertexAttribBuilder.set_name("pos").build();
-	const VertexAttribute colorAttrib = vertexAttribBuilder.set_name("color").build();
+	vbo.add_layout<ColoredLayout>();
 
-	vbo1.add_attribute(posAttrib);
-	vbo2.add_attribute(colorAttrib);
-
-	triangle.buffer_to(vbo1);
-	triangleBravo.buffer_to(vbo1);
+	const ColoredVertex vertices[] {
+		{ triangle.a, pack_unorm8(vec( 1, 0, 0, 1 )) },
+		{ triangle.b, pack_unorm8(vec( 1, 1, 0, 1 )) },
+		{ triangle.c, pack_unorm8(vec( 1, 1, 1, 1 )) },
+		{ triangleBravo.a, pack_unorm8(vec( 0, 1, 0, 1 )) },
+		{ triangleBravo.b, pack_unorm8(vec( 0, 1, 1, 1 )) },
+		{ triangleBravo.c, pack_unorm8(vec( 1, 1, 1, 1 )) }
+	};
+	vbo.buffer(std::span<const ColoredVertex>(vertices));
+	vbo.flush();
 
-	vbo2.buffer(vec(1, 0, 0));
-	vbo2.buffer(vec( 1, 1, 0 ));
-	vbo2.buffer(vec( 1, 1, 1 ));
-	vbo2.buffer(vec( 0, 1, 0 ));
-	vbo2.buffer(vec( 0, 1, 1 ));
-	vbo2.buffer(vec( 1, 1, 1 ));
+	UniformBlock<Globals> globals("Globals", 0);
+	globals.attach(shaderProgram);
 
 	auto u_green = shaderProgram.uniform<float>("u_green");
-	auto u_offset = shaderProgram.uniform<Vector3>("u_offset");
-	auto u_time = shaderProgram.uniform<float>("u_time");
-
 	spdlog::info("u_green.is_blank() == {}", u_green.is_blank());
-	spdlog::info("u_time.is_blank() == {}", u_time.is_blank());
-
-	u_time.set_value(1024);
-	spdlog::info("u_time.value() == {}", u_time.value());
 
 	auto u_secret = shaderProgram.uniform<int>("u_secret");
 	u_secret.set_value(1024);
@@ -121,15 +131,20 @@ int main() {
 		glClear(GL_COLOR_BUFFER_BIT);
 
 		controls.process();
-		update_uniforms(u_green, u_offset);
+		update_uniforms(u_green, globals);
+		globals.bind();
 
 		VAO.bind();
-		glDrawArrays(GL_TRIANGLES, 0, vbo1.size() / (3 * sizeof(float)));
+		glDrawArrays(GL_TRIANGLES, 0, vbo.vertex_count());
 
 		window.swap_buffers();
 		glfwPollEvents();
 	}
 
+	const GLStateCache& state = GLStateCache::current();
+	spdlog::info("GL state cache avoided {} of {} state changes",
+		state.avoided_calls(), state.avoided_calls() + state.issued_calls());
+
 	glfwTerminate();
 	return 0;
 }
@@ -144,25 +159,24 @@ void postpone_closing(Window& window, int seconds) {
 	t.detach();
 }
 
-ShaderProgram create_shader_program() {
+ShaderVariants create_shader_variants(ProgramBinaryCache& cache) {
 	using namespace tetragon;
-	const char* vertexShaderSource = RESOURCE_VERTEX_VERT;
-	const char* fragmentShaderSource = RESOURCE_FRAGMENT_FRAG;
-	const Shader vertexShader(ShaderType::VERTEX, vertexShaderSource);
-	const Shader fragmentShader(ShaderType::FRAGMENT, fragmentShaderSource);
-	return ShaderProgram::Builder()
-		.attach_shader(vertexShader)
-		.attach_shader(fragmentShader)
-		.build();
+	ShaderVariants variants({
+		{ ShaderType::VERTEX, RESOURCE_VERTEX_VERT },
+		{ ShaderType::FRAGMENT, RESOURCE_FRAGMENT_FRAG }
+	}, {}, &cache);
+	variants.add_feature("TINT_GREEN");
+	return variants;
 }
 
-void update_uniforms(Uniform<float> u_green, Uniform<Vector3> u_offset) {
+void update_uniforms(Uniform<float> u_green, UniformBlock<Globals>& globals) {
 	const float time = glfwGetTime();
 	const float timeSin = sin(time);
 	const float greenValue = fabs(timeSin);
 	u_green.set_value(greenValue);
 
 	constexpr float length = .5f;
-	const Vector3 offset{ length * (1.f - timeSin) - length, 0, 0 };
-	u_offset.set_value(offset);
+	Globals& values = globals.edit();
+	values.offset = Vector3{ length * (1.f - timeSin) - length, 0, 0 };
+	values.time = time;
 }
@@ -0,0 +1,30 @@
+#ifndef TETRAGON_TESTS_CHECK_HPP
+#define TETRAGON_TESTS_CHECK_HPP
+
+#include <atomic>
+#include <cstdio>
+
+namespace tetragon::tests {
+
+// Failed checks are counted instead of aborting, so a test executable
+// reports every failure and main returns non-zero. Safe to use from jobs.
+inline std::atomic<int> failures = 0;
+
+inline int result() {
+	if (failures > 0) {
+		std::fprintf(stderr, "%d checks failed\n", failures.load());
+	}
+	return failures > 0 ? 1 : 0;
+}
+
+} // tetragon::tests
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			tetragon::tests::failures++; \
+		} \
+	} while (false)
+
+#endif // TETRAGON_TESTS_CHECK_HPP
@@ -0,0 +1,125 @@
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <tetragon/graphics/formats.hpp>
+
+#include "check.hpp"
+
+using namespace tetragon::graphics;
+
+namespace {
+	constexpr std::uint16_t HALF_INFINITY = 0x7c00;
+
+	bool is_half_nan(const std::uint16_t half) {
+		return (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+	}
+
+	// Every half converts to float exactly, so converting back has to give
+	// the same bits; NaNs only have to stay NaNs.
+	void test_half_round_trip() {
+		for (std::uint32_t bits = 0; bits <= 0xffff; bits++) {
+			const auto half = static_cast<std::uint16_t>(bits);
+			const float value = half_to_float(half);
+			if (is_half_nan(half)) {
+				CHECK(std::isnan(value));
+				CHECK(is_half_nan(float_to_half(value)));
+			} else {
+				CHECK(float_to_half(value) == half);
+			}
+		}
+	}
+
+	// The chosen half has to be at least as close as both of its neighbours,
+	// and on a tie its mantissa has to be even.
+	void test_half_rounding() {
+		for (std::uint64_t bits = 0; bits < 0x80000000; bits += 4099) {
+			for (const std::uint32_t sign : { 0u, 0x80000000u }) {
+				const float value = std::bit_cast<float>(static_cast<std::uint32_t>(bits) | sign);
+				const std::uint16_t half = float_to_half(value);
+				if (std::abs(value) >= 65520.f) {
+					CHECK((half & 0x7fff) == HALF_INFINITY);
+					continue;
+				}
+				const double distance = std::abs(static_cast<double>(half_to_float(half)) - value);
+				for (const int step : { -1, 1 }) {
+					const int magnitude = (half & 0x7fff) + step;
+					if (magnitude < 0 || magnitude >= HALF_INFINITY) continue;
+					const auto neighbour = static_cast<std::uint16_t>((half & 0x8000) | magnitude);
+					const double other = std::abs(static_cast<double>(half_to_float(neighbour)) - value);
+					CHECK(distance <= other);
+					if (distance == other) CHECK((half & 1) == 0);
+				}
+			}
+		}
+	}
+
+	void test_half_special_values() {
+		CHECK(float_to_half(1.f) == 0x3c00);
+		CHECK(float_to_half(-2.f) == 0xc000);
+		CHECK(float_to_half(65504.f) == 0x7bff);
+		CHECK(float_to_half(65519.f) == 0x7bff);
+		CHECK(float_to_half(65520.f) == HALF_INFINITY);
+		CHECK(float_to_half(std::numeric_limits<float>::infinity()) == HALF_INFINITY);
+		CHECK(float_to_half(-std::numeric_limits<float>::infinity()) == (0x8000 | HALF_INFINITY));
+		CHECK(is_half_nan(float_to_half(std::numeric_limits<float>::quiet_NaN())));
+		CHECK(float_to_half(std::ldexp(1.f, -24)) == 0x0001);
+		CHECK(float_to_half(std::ldexp(1.f, -25)) == 0x0000);
+		CHECK(float_to_half(std::ldexp(3.f, -25)) == 0x0002);
+		CHECK(float_to_half(-0.f) == 0x8000);
+	}
+
+	// The batch kernels may take a SIMD path, which has to agree with the
+	// scalar conversion.
+	void test_compress_matches_scalar() {
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> range(-70000.f, 70000.f);
+		std::uniform_real_distribution<float> small(-1e-3f, 1e-3f);
+		std::vector<Vector4> vectors(1027);
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+			auto& distribution = i % 2 == 0 ? range : small;
+			vectors[i] = { distribution(random), distribution(random), distribution(random), distribution(random) };
+		}
+		std::vector<Half4> halves(vectors.size());
+		kernels::compress(vectors, halves);
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+			const Half4 expected = pack_half(vectors[i]);
+			for (int j = 0; j < 4; j++) {
+				CHECK(halves[i].values[j] == expected.values[j]);
+			}
+		}
+	}
+
+	// NaN components clamp to the lower end of the range on both paths
+	void test_compress_nan() {
+		constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+		const std::vector<Vector4> vectors(5, Vector4 { nan, 0.5f, nan, 1.f });
+		std::vector<Snorm16x4> snorms(vectors.size());
+		std::vector<Unorm8x4> unorms(vectors.size());
+		kernels::compress(vectors, snorms);
+		kernels::compress(vectors, unorms);
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+			const Snorm16x4 snorm = pack_snorm16(vectors[i]);
+			const Unorm8x4 unorm = pack_unorm8(vectors[i]);
+			CHECK(snorm.values[0] == -32767 && snorm.values[2] == -32767);
+			CHECK(unorm.values[0] == 0 && unorm.values[2] == 0);
+			for (int j = 0; j < 4; j++) {
+				CHECK(snorms[i].values[j] == snorm.values[j]);
+				CHECK(unorms[i].values[j] == unorm.values[j]);
+			}
+		}
+		const PackedNormal normal = pack_normal({ nan, 0, 1 });
+		CHECK((normal.bits & 0x3ff) == 0x201);
+	}
+}
+
+int main() {
+	test_half_round_trip();
+	test_half_rounding();
+	test_half_special_values();
+	test_compress_matches_scalar();
+	test_compress_nan();
+	return tetragon::tests::result();
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include <tetragon/jobs.hpp>
+
+#include "check.hpp"
+
+using namespace tetragon::jobs;
+
+namespace {
+	constexpr int REPETITIONS = 20;
+
+	void test_parallel_for(Scheduler& scheduler) {
+		std::vector<int> values(100000, 0);
+		scheduler.parallel_for(0, values.size(), 1000, [&](const std::size_t first, const std::size_t last) {
+			for (std::size_t i = first; i < last; i++) values[i]++;
+		});
+		CHECK(std::ranges::all_of(values, [](const int value) { return value == 1; }));
+	}
+
+	void test_nested_parallel_for(Scheduler& scheduler) {
+		std::atomic<std::size_t> sum = 0;
+		scheduler.parallel_for(0, 16, [&](const std::size_t first, const std::size_t last) {
+			for (std::size_t i = first; i < last; i++) {
+				scheduler.parallel_for(0, 1000, 10, [&](const std::size_t begin, const std::size_t end) {
+					sum += end - begin;
+				});
+			}
+		});
+		CHECK(sum == 16000);
+	}
+
+	void test_dependencies(Scheduler& scheduler) {
+		Counter first, second, third;
+		std::atomic<int> stage = 0;
+		for (int i = 0; i < 10; i++) {
+			scheduler.submit([&] { stage++; }, &first);
+		}
+		scheduler.submit_after(first, [&] {
+			CHECK(stage == 10);
+			stage += 100;
+		}, &second);
+		scheduler.submit_after(second, [&] {
+			CHECK(stage == 110);
+			stage += 1000;
+		}, &third);
+		scheduler.wait(third);
+		CHECK(stage == 1110);
+		CHECK(first.done() && second.done() && third.done());
+	}
+
+	void test_exceptions(Scheduler& scheduler) {
+		bool caught = false;
+		try {
+			scheduler.parallel_for(0, 100, 1, [](const std::size_t first, const std::size_t last) {
+				if (first <= 57 && 57 < last) throw std::runtime_error("Failed chunk");
+			});
+		} catch (std::runtime_error const&) {
+			caught = true;
+		}
+		CHECK(caught);
+
+		Counter counter;
+		std::atomic<int> finished = 0;
+		for (int i = 0; i < 8; i++) {
+			scheduler.submit([&finished, i] {
+				if (i == 3) throw std::out_of_range("Failed job");
+				finished++;
+			}, &counter);
+		}
+		caught = false;
+		try {
+			scheduler.wait(counter);
+		} catch (std::out_of_range const&) {
+			caught = true;
+		}
+		CHECK(caught);
+		CHECK(finished == 7);
+		CHECK(counter.done());
+	}
+
+	void test_single_worker() {
+		Scheduler scheduler(1);
+		std::mutex mutex;
+		std::size_t total = 0;
+		scheduler.parallel_for(0, 100, 1, [&](const std::size_t first, const std::size_t last) {
+			std::lock_guard lock(mutex);
+			total += last - first;
+		});
+		CHECK(total == 100);
+	}
+}
+
+int main() {
+	Scheduler scheduler(4);
+	for (int i = 0; i < REPETITIONS; i++) {
+		test_parallel_for(scheduler);
+		test_nested_parallel_for(scheduler);
+		test_dependencies(scheduler);
+		test_exceptions(scheduler);
+	}
+	test_single_worker();
+	return tetragon::tests::result();
+}
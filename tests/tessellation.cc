@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+#include <tetragon/graphics/tessellation.hpp>
+
+#include "check.hpp"
+
+using namespace tetragon::graphics;
+
+namespace {
+	using Index = ElementBuffer::Index;
+
+	struct Mesh {
+		std::vector<Vector3> vertices;
+		std::vector<Index> indices;
+	};
+
+	Mesh tessellate(Tessellator& tessellator, TessellationBatch const& batch) {
+		Mesh mesh;
+		const auto indices = tessellator.tessellate(batch, mesh.vertices);
+		mesh.indices.assign(indices.begin(), indices.end());
+		return mesh;
+	}
+
+	// Sum of the signed triangle areas. Every triangle has to be counter-
+	// clockwise, so a wrongly wound or folded triangle fails the check.
+	double area(Mesh const& mesh) {
+		double total = 0;
+		for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			const Index a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+			CHECK(a < mesh.vertices.size() && b < mesh.vertices.size() && c < mesh.vertices.size());
+			if (std::max({ a, b, c }) >= mesh.vertices.size()) return 0;
+			Vector3 const& p = mesh.vertices[a], & q = mesh.vertices[b], & r = mesh.vertices[c];
+			const double triangle = ((q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x)) / 2.0;
+			CHECK(triangle >= -1e-6);
+			total += triangle;
+		}
+		return total;
+	}
+
+	double polygon_area(std::vector<Vector2> const& points) {
+		double area = 0;
+		for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+			area += points[j].x * points[i].y - points[i].x * points[j].y;
+		}
+		return std::abs(area) / 2;
+	}
+
+	bool near(const double value, const double expected, const double tolerance = 1e-5) {
+		return std::abs(value - expected) <= tolerance * std::max(1.0, std::abs(expected));
+	}
+
+	void test_rectangle(Tessellator& tessellator) {
+		TessellationBatch batch;
+		batch.add(Rectangle { vec(0.f, 0.f), vec(2.f, 3.f) });
+		CHECK(near(area(tessellate(tessellator, batch)), 6));
+	}
+
+	void test_ellipse(Tessellator& tessellator) {
+		TessellationBatch batch;
+		batch.add(Ellipse { vec(1.f, 1.f), vec(2.f, 1.f) });
+		CHECK(near(area(tessellate(tessellator, batch)), 2 * std::numbers::pi, 1e-2));
+	}
+
+	// Random star-shaped polygons are simple but mostly concave, so they go
+	// through the ear clipper; odd ones are reversed to cover both windings.
+	void test_concave_polygons(Tessellator& tessellator) {
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> unit(0, 1);
+		for (int i = 0; i < 300; i++) {
+			const int count = 3 + static_cast<int>(random() % 60);
+			std::vector<Vector2> points;
+			for (int j = 0; j < count; j++) {
+				const float angle = 2 * std::numbers::pi_v<float> * (j + 0.3f * unit(random)) / count;
+				const float radius = 0.2f + unit(random);
+				points.push_back(vec(radius * std::cos(angle), radius * std::sin(angle)));
+			}
+			if (i % 2 == 1) std::ranges::reverse(points);
+
+			TessellationBatch batch;
+			batch.add_polygon(points);
+			const Mesh mesh = tessellate(tessellator, batch);
+			CHECK(mesh.indices.size() == 3 * (points.size() - 2));
+			CHECK(near(area(mesh), polygon_area(points), 1e-4));
+		}
+	}
+
+	void test_strokes(Tessellator& tessellator) {
+		TessellationBatch open;
+		const Vector2 line[] { vec(0.f, 0.f), vec(1.f, 0.f), vec(3.f, 0.f) };
+		open.add_polyline(line, 0.5f);
+		CHECK(near(area(tessellate(tessellator, open)), 1.5));
+
+		TessellationBatch closed;
+		const Vector2 square[] { vec(0.f, 0.f), vec(1.f, 0.f), vec(1.f, 1.f), vec(0.f, 1.f) };
+		closed.add_polyline(square, 0.2f, true);
+		CHECK(near(area(tessellate(tessellator, closed)), 1.2 * 1.2 - 0.8 * 0.8, 1e-4));
+	}
+
+	// Chunks are written into disjoint ranges, so the result must not depend
+	// on the number of workers.
+	void test_parallel_matches_serial() {
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> unit(0, 1);
+		TessellationBatch batch;
+		for (int i = 0; i < 20000; i++) {
+			switch (i % 4) {
+				case 0:
+					batch.add(Rectangle { vec(unit(random), unit(random)), vec(1 + unit(random), 1 + unit(random)) });
+					break;
+				case 1:
+					batch.add_circle(vec(unit(random), unit(random)), 0.1f * unit(random));
+					break;
+				case 2: {
+					const Vector2 points[] { vec(0.f, 0.f), vec(1.f, 0.f), vec(0.5f, 0.2f), vec(0.5f, 1.f) };
+					batch.add_polygon(points);
+					break;
+				}
+				default: {
+					const Vector2 points[] {
+						vec(unit(random), unit(random)), vec(unit(random), unit(random)), vec(unit(random), unit(random))
+					};
+					batch.add_polyline(points, 0.01f);
+				}
+			}
+		}
+
+		tetragon::jobs::Scheduler one(1), four(4);
+		Tessellator serial(Tessellator::DEFAULT_TOLERANCE, one), parallel(Tessellator::DEFAULT_TOLERANCE, four);
+		const Mesh expected = tessellate(serial, batch), actual = tessellate(parallel, batch);
+		CHECK(parallel.statistics().chunks > 1);
+		CHECK(actual.indices == expected.indices);
+		CHECK(std::ranges::equal(actual.vertices, expected.vertices, [](Vector3 const& a, Vector3 const& b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}));
+	}
+}
+
+int main() {
+	tetragon::jobs::Scheduler scheduler(1);
+	Tessellator tessellator(Tessellator::DEFAULT_TOLERANCE, scheduler);
+	test_rectangle(tessellator);
+	test_ellipse(tessellator);
+	test_concave_polygons(tessellator);
+	test_strokes(tessellator);
+	test_parallel_matches_serial();
+	return tetragon::tests::result();
+}